@@ -0,0 +1,571 @@
+#include <cmath>
+#include <atomic>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include "Json.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "GltfImporter.h"
+
+namespace
+{
+	constexpr uint32_t glbMagic = 0x46546C67;		// "glTF"
+	constexpr uint32_t glbChunkJson = 0x4E4F534A;	// "JSON"
+	constexpr uint32_t glbChunkBin = 0x004E4942;	// "BIN\0"
+
+	constexpr int componentByte = 5120;
+	constexpr int componentUnsignedByte = 5121;
+	constexpr int componentShort = 5122;
+	constexpr int componentUnsignedShort = 5123;
+	constexpr int componentUnsignedInt = 5125;
+	constexpr int componentFloat = 5126;
+
+	constexpr int modeTriangles = 4;
+
+	struct Span
+	{
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Column major, like glTF
+	struct Matrix
+	{
+		float m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	};
+
+	Matrix Multiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix result;
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++)
+				{
+					sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+				}
+				result.m[column * 4 + row] = sum;
+			}
+		}
+		return result;
+	}
+
+	// A view of accessor data, every element is read through here regardless of its component type
+	struct Accessor
+	{
+		const uint8_t* data = nullptr;
+		size_t count = 0;
+		size_t stride = 0;
+		int componentType = 0;
+		int components = 0;
+		bool isNormalized = false;
+
+		bool IsValid() const
+		{
+			return data != nullptr;
+		}
+
+		void ReadFloats(size_t index, float* values) const
+		{
+			const uint8_t* element = data + index * stride;
+			for (int i = 0; i < components; i++)
+			{
+				switch (componentType)
+				{
+				case componentFloat:
+					std::memcpy(&values[i], element + i * sizeof(float), sizeof(float));
+					break;
+				case componentUnsignedByte:
+					values[i] = element[i] / (isNormalized ? 255.0f : 1.0f);
+					break;
+				case componentUnsignedShort:
+				{
+					uint16_t value;
+					std::memcpy(&value, element + i * sizeof(uint16_t), sizeof(uint16_t));
+					values[i] = value / (isNormalized ? 65535.0f : 1.0f);
+					break;
+				}
+				case componentByte:
+					values[i] = isNormalized ? std::max(static_cast<int8_t>(element[i]) / 127.0f, -1.0f) : static_cast<int8_t>(element[i]);
+					break;
+				case componentShort:
+				{
+					int16_t value;
+					std::memcpy(&value, element + i * sizeof(int16_t), sizeof(int16_t));
+					values[i] = isNormalized ? std::max(value / 32767.0f, -1.0f) : value;
+					break;
+				}
+				default:
+					values[i] = 0.0f;
+				}
+			}
+		}
+
+		uint32_t ReadIndex(size_t index) const
+		{
+			const uint8_t* element = data + index * stride;
+			switch (componentType)
+			{
+			case componentUnsignedByte:
+				return element[0];
+			case componentUnsignedShort:
+			{
+				uint16_t value;
+				std::memcpy(&value, element, sizeof(value));
+				return value;
+			}
+			default:
+			{
+				uint32_t value;
+				std::memcpy(&value, element, sizeof(value));
+				return value;
+			}
+			}
+		}
+	};
+
+	struct Primitive
+	{
+		int primitive;
+		Matrix transform;
+	};
+
+	class GltfFile
+	{
+	public:
+		bool Open(const char* path);
+		bool Import(ImportedMesh& mesh, unsigned int threadCount);
+
+	private:
+		bool LoadBuffers();
+		Accessor GetAccessor(int index) const;
+		void CollectPrimitives(int node, const Matrix& parent, int depth);
+		bool DecodePrimitive(const Primitive& primitive, ImportedSubMesh& subMesh) const;
+
+	private:
+		std::string m_Path;
+		MappedFile m_File;
+		JsonDocument m_Json;
+		Span m_GlbBinary;
+
+		std::vector<Span> m_Buffers;
+		std::vector<std::unique_ptr<MappedFile>> m_ExternalBuffers;
+		std::vector<std::vector<uint8_t>> m_DecodedBuffers;
+
+		std::vector<Primitive> m_Primitives;
+	};
+
+	bool DecodeBase64(std::string_view text, std::vector<uint8_t>& output)
+	{
+		auto decode = [](char c) -> int
+		{
+			if (c >= 'A' && c <= 'Z') return c - 'A';
+			if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+			if (c >= '0' && c <= '9') return c - '0' + 52;
+			if (c == '+') return 62;
+			if (c == '/') return 63;
+			return -1;
+		};
+
+		output.reserve(text.size() / 4 * 3);
+		uint32_t bits = 0;
+		int bitCount = 0;
+		for (char c : text)
+		{
+			if (c == '=')
+			{
+				break;
+			}
+			int value = decode(c);
+			if (value < 0)
+			{
+				return false;
+			}
+			bits = (bits << 6) | value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				output.push_back(static_cast<uint8_t>(bits >> bitCount));
+			}
+		}
+		return true;
+	}
+
+	bool GltfFile::Open(const char* path)
+	{
+		m_Path = path;
+		if (!m_File.Open(path))
+		{
+			return false;
+		}
+
+		const uint8_t* data = m_File.GetData();
+		size_t size = m_File.GetSize();
+
+		uint32_t magic = 0;
+		if (size >= sizeof(magic))
+		{
+			std::memcpy(&magic, data, sizeof(magic));
+		}
+
+		if (magic != glbMagic)
+		{
+			return m_Json.Parse(reinterpret_cast<const char*>(data), size) && LoadBuffers();
+		}
+
+		// .glb: 12 byte header, a JSON chunk, then an optional BIN chunk
+		uint32_t header[3];
+		if (size < sizeof(header))
+		{
+			std::cerr << "ERROR::GLTF_IMPORTER::TRUNCATED " << path << std::endl;
+			return false;
+		}
+		std::memcpy(header, data, sizeof(header));
+		if (header[1] != 2 || header[2] > size)
+		{
+			std::cerr << "ERROR::GLTF_IMPORTER::UNSUPPORTED_GLB " << path << std::endl;
+			return false;
+		}
+
+		bool hasJson = false;
+		for (size_t offset = sizeof(header); offset + 8 <= header[2];)
+		{
+			uint32_t chunk[2];
+			std::memcpy(chunk, data + offset, sizeof(chunk));
+			offset += sizeof(chunk);
+			if (chunk[0] > header[2] - offset)
+			{
+				std::cerr << "ERROR::GLTF_IMPORTER::BAD_CHUNK " << path << std::endl;
+				return false;
+			}
+
+			if (chunk[1] == glbChunkJson && !hasJson)
+			{
+				hasJson = m_Json.Parse(reinterpret_cast<const char*>(data + offset), chunk[0]);
+				if (!hasJson)
+				{
+					return false;
+				}
+			}
+			else if (chunk[1] == glbChunkBin && !m_GlbBinary.data)
+			{
+				m_GlbBinary = { data + offset, chunk[0] };
+			}
+			offset += chunk[0];
+		}
+
+		if (!hasJson)
+		{
+			std::cerr << "ERROR::GLTF_IMPORTER::NO_JSON_CHUNK " << path << std::endl;
+			return false;
+		}
+		return LoadBuffers();
+	}
+
+	bool GltfFile::LoadBuffers()
+	{
+		int buffers = m_Json.Find(JsonDocument::root, "buffers");
+		int count = static_cast<int>(m_Json.GetCount(buffers));
+		m_Buffers.resize(count);
+
+		for (int i = 0, buffer = m_Json.First(buffers); i < count; i++, buffer = m_Json.Next(buffer))
+		{
+			size_t byteLength = m_Json.GetSize(m_Json.Find(buffer, "byteLength"));
+			std::string_view uri = m_Json.GetString(m_Json.Find(buffer, "uri"));
+
+			Span span;
+			if (uri.empty())
+			{
+				// The first buffer of a .glb without a uri is the BIN chunk
+				span = m_GlbBinary;
+			}
+			else if (uri.substr(0, 5) == "data:")
+			{
+				size_t comma = uri.find(',');
+				if (comma == std::string_view::npos || uri.substr(0, comma).find(";base64") == std::string_view::npos)
+				{
+					std::cerr << "ERROR::GLTF_IMPORTER::UNSUPPORTED_DATA_URI buffer " << i << std::endl;
+					return false;
+				}
+				m_DecodedBuffers.emplace_back();
+				if (!DecodeBase64(uri.substr(comma + 1), m_DecodedBuffers.back()))
+				{
+					std::cerr << "ERROR::GLTF_IMPORTER::BAD_BASE64 buffer " << i << std::endl;
+					return false;
+				}
+				span = { m_DecodedBuffers.back().data(), m_DecodedBuffers.back().size() };
+			}
+			else
+			{
+				// Relative to the .gltf, percent escapes are not decoded
+				std::string bufferPath = (std::filesystem::path(m_Path).parent_path() / std::string(uri)).string();
+				m_ExternalBuffers.push_back(std::make_unique<MappedFile>());
+				if (!m_ExternalBuffers.back()->Open(bufferPath.c_str()))
+				{
+					return false;
+				}
+				span = { m_ExternalBuffers.back()->GetData(), m_ExternalBuffers.back()->GetSize() };
+			}
+
+			if (span.size < byteLength)
+			{
+				std::cerr << "ERROR::GLTF_IMPORTER::BUFFER_TOO_SMALL buffer " << i << std::endl;
+				return false;
+			}
+			m_Buffers[i] = span;
+		}
+		return true;
+	}
+
+	Accessor GltfFile::GetAccessor(int index) const
+	{
+		Accessor accessor;
+		int json = m_Json.GetElement(m_Json.Find(JsonDocument::root, "accessors"), index);
+		int bufferView = m_Json.GetElement(m_Json.Find(JsonDocument::root, "bufferViews"), m_Json.GetInt(m_Json.Find(json, "bufferView")));
+		if (json < 0 || bufferView < 0)
+		{
+			// Sparse accessors and accessors without a buffer view are not supported
+			return accessor;
+		}
+
+		int buffer = m_Json.GetInt(m_Json.Find(bufferView, "buffer"));
+		if (buffer < 0 || buffer >= static_cast<int>(m_Buffers.size()))
+		{
+			return accessor;
+		}
+
+		std::string_view type = m_Json.GetString(m_Json.Find(json, "type"));
+		int components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+		int componentType = m_Json.GetInt(m_Json.Find(json, "componentType"), 0);
+		size_t componentSize = componentType == componentFloat || componentType == componentUnsignedInt ? 4
+			: componentType == componentShort || componentType == componentUnsignedShort ? 2 : 1;
+		size_t elementSize = components * componentSize;
+
+		size_t viewOffset = m_Json.GetSize(m_Json.Find(bufferView, "byteOffset"));
+		size_t viewLength = m_Json.GetSize(m_Json.Find(bufferView, "byteLength"));
+		size_t offset = m_Json.GetSize(m_Json.Find(json, "byteOffset"));
+		size_t stride = m_Json.GetSize(m_Json.Find(bufferView, "byteStride"), elementSize);
+		size_t count = m_Json.GetSize(m_Json.Find(json, "count"));
+
+		// Everything the accessor touches has to be inside the view, and the view inside the buffer.
+		// Only subtractions of values already known to be smaller and a division, products could wrap around.
+		const Span& span = m_Buffers[buffer];
+		bool isInBounds = components > 0 && stride >= elementSize
+			&& viewOffset <= span.size && viewLength <= span.size - viewOffset
+			&& (count == 0 || (offset <= viewLength && viewLength - offset >= elementSize
+				&& count - 1 <= (viewLength - offset - elementSize) / stride));
+		if (!isInBounds)
+		{
+			std::cerr << "ERROR::GLTF_IMPORTER::ACCESSOR_OUT_OF_BOUNDS " << index << std::endl;
+			return accessor;
+		}
+
+		accessor.data = span.data + viewOffset + offset;
+		accessor.count = count;
+		accessor.stride = stride;
+		accessor.componentType = componentType;
+		accessor.components = components;
+		accessor.isNormalized = m_Json.GetBool(m_Json.Find(json, "normalized"));
+		return accessor;
+	}
+
+	void GltfFile::CollectPrimitives(int nodeIndex, const Matrix& parent, int depth)
+	{
+		int node = m_Json.GetElement(m_Json.Find(JsonDocument::root, "nodes"), nodeIndex);
+		// The depth limit guards against cycles in broken files
+		if (node < 0 || depth > 64)
+		{
+			return;
+		}
+
+		Matrix local;
+		int matrix = m_Json.Find(node, "matrix");
+		if (m_Json.GetCount(matrix) == 16)
+		{
+			for (int i = 0, element = m_Json.First(matrix); i < 16; i++, element = m_Json.Next(element))
+			{
+				local.m[i] = static_cast<float>(m_Json.GetNumber(element));
+			}
+		}
+		else
+		{
+			float t[3] = { 0, 0, 0 };
+			float r[4] = { 0, 0, 0, 1 };
+			float s[3] = { 1, 1, 1 };
+			auto read = [this](int array, float* values, int count)
+			{
+				if (static_cast<int>(m_Json.GetCount(array)) != count)
+				{
+					return;
+				}
+				for (int i = 0, element = m_Json.First(array); i < count; i++, element = m_Json.Next(element))
+				{
+					values[i] = static_cast<float>(m_Json.GetNumber(element));
+				}
+			};
+			read(m_Json.Find(node, "translation"), t, 3);
+			read(m_Json.Find(node, "rotation"), r, 4);
+			read(m_Json.Find(node, "scale"), s, 3);
+
+			// T * R * S, rotation is a unit quaternion (x, y, z, w)
+			float x = r[0], y = r[1], z = r[2], w = r[3];
+			float rotation[9] = {
+				1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w),
+				2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+				2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)
+			};
+			for (int column = 0; column < 3; column++)
+			{
+				for (int row = 0; row < 3; row++)
+				{
+					local.m[column * 4 + row] = rotation[column * 3 + row] * s[column];
+				}
+			}
+			local.m[12] = t[0];
+			local.m[13] = t[1];
+			local.m[14] = t[2];
+		}
+
+		Matrix world = Multiply(parent, local);
+
+		int mesh = m_Json.GetElement(m_Json.Find(JsonDocument::root, "meshes"), m_Json.GetInt(m_Json.Find(node, "mesh")));
+		int primitives = m_Json.Find(mesh, "primitives");
+		for (int i = 0, primitive = m_Json.First(primitives); i < static_cast<int>(m_Json.GetCount(primitives)); i++, primitive = m_Json.Next(primitive))
+		{
+			m_Primitives.push_back({ primitive, world });
+		}
+
+		int children = m_Json.Find(node, "children");
+		for (int i = 0, child = m_Json.First(children); i < static_cast<int>(m_Json.GetCount(children)); i++, child = m_Json.Next(child))
+		{
+			CollectPrimitives(m_Json.GetInt(child), world, depth + 1);
+		}
+	}
+
+	bool GltfFile::DecodePrimitive(const Primitive& primitive, ImportedSubMesh& subMesh) const
+	{
+		if (m_Json.GetInt(m_Json.Find(primitive.primitive, "mode"), modeTriangles) != modeTriangles)
+		{
+			// Points and lines have no place in a triangle mesh, strips and fans are rare enough to skip
+			return true;
+		}
+
+		int attributes = m_Json.Find(primitive.primitive, "attributes");
+		Accessor positions = GetAccessor(m_Json.GetInt(m_Json.Find(attributes, "POSITION")));
+		if (!positions.IsValid() || positions.components != 3)
+		{
+			std::cerr << "ERROR::GLTF_IMPORTER::NO_POSITIONS" << std::endl;
+			return false;
+		}
+
+		int colorIndex = m_Json.GetInt(m_Json.Find(attributes, "COLOR_0"));
+		Accessor colors = colorIndex >= 0 ? GetAccessor(colorIndex) : Accessor();
+		if (colors.IsValid() && (colors.count < positions.count || colors.components < 3))
+		{
+			colors = Accessor();
+		}
+
+		int indicesIndex = m_Json.GetInt(m_Json.Find(primitive.primitive, "indices"));
+		Accessor indices = indicesIndex >= 0 ? GetAccessor(indicesIndex) : Accessor();
+		if (indicesIndex >= 0 && !indices.IsValid())
+		{
+			return false;
+		}
+		size_t cornerCount = indices.IsValid() ? indices.count : positions.count;
+		cornerCount -= cornerCount % 3;
+
+		const float* m = primitive.transform.m;
+		subMesh.triangles.resize(cornerCount);
+		for (size_t i = 0; i < cornerCount; i++)
+		{
+			size_t index = indices.IsValid() ? indices.ReadIndex(i) : i;
+			if (index >= positions.count)
+			{
+				std::cerr << "ERROR::GLTF_IMPORTER::INDEX_OUT_OF_RANGE " << index << std::endl;
+				return false;
+			}
+
+			float position[3];
+			positions.ReadFloats(index, position);
+			float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			if (colors.IsValid())
+			{
+				colors.ReadFloats(index, color);
+			}
+
+			ImportedVertex& vertex = subMesh.triangles[i];
+			vertex.x = m[0] * position[0] + m[4] * position[1] + m[8] * position[2] + m[12];
+			vertex.y = m[1] * position[0] + m[5] * position[1] + m[9] * position[2] + m[13];
+			vertex.z = m[2] * position[0] + m[6] * position[1] + m[10] * position[2] + m[14];
+			vertex.r = color[0];
+			vertex.g = color[1];
+			vertex.b = color[2];
+		}
+		return true;
+	}
+
+	bool GltfFile::Import(ImportedMesh& mesh, unsigned int threadCount)
+	{
+		int scenes = m_Json.Find(JsonDocument::root, "scenes");
+		int scene = m_Json.GetElement(scenes, std::max(0, m_Json.GetInt(m_Json.Find(JsonDocument::root, "scene"), 0)));
+		Matrix identity;
+		if (scene >= 0)
+		{
+			int nodes = m_Json.Find(scene, "nodes");
+			for (int i = 0, node = m_Json.First(nodes); i < static_cast<int>(m_Json.GetCount(nodes)); i++, node = m_Json.Next(node))
+			{
+				CollectPrimitives(m_Json.GetInt(node), identity, 0);
+			}
+		}
+		else
+		{
+			// No scene: take every mesh as is
+			int meshes = m_Json.Find(JsonDocument::root, "meshes");
+			for (int i = 0, json = m_Json.First(meshes); i < static_cast<int>(m_Json.GetCount(meshes)); i++, json = m_Json.Next(json))
+			{
+				int primitives = m_Json.Find(json, "primitives");
+				for (int j = 0, primitive = m_Json.First(primitives); j < static_cast<int>(m_Json.GetCount(primitives)); j++, primitive = m_Json.Next(primitive))
+				{
+					m_Primitives.push_back({ primitive, identity });
+				}
+			}
+		}
+
+		mesh.subMeshes.resize(m_Primitives.size());
+		std::atomic<bool> isValid = true;
+		ParallelFor(m_Primitives.size(), threadCount, [&](size_t i)
+		{
+			if (!DecodePrimitive(m_Primitives[i], mesh.subMeshes[i]))
+			{
+				isValid = false;
+			}
+		});
+
+		// Drop primitives that were skipped
+		mesh.subMeshes.erase(std::remove_if(mesh.subMeshes.begin(), mesh.subMeshes.end(), [](const ImportedSubMesh& subMesh)
+		{
+			return subMesh.triangles.empty();
+		}), mesh.subMeshes.end());
+
+		if (isValid && mesh.subMeshes.empty())
+		{
+			std::cerr << "ERROR::GLTF_IMPORTER::NO_TRIANGLES " << m_Path << std::endl;
+			return false;
+		}
+		return isValid;
+	}
+}
+
+bool ImportGltf(const char* path, ImportedMesh& mesh, unsigned int threadCount)
+{
+	GltfFile file;
+	return file.Open(path) && file.Import(mesh, threadCount);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "ImportedMesh.h"
+
+// glTF 2.0, both .gltf (with external or data: URI buffers) and binary .glb.
+// Every triangle primitive reachable from the default scene becomes a sub-mesh with its node transform baked in.
+// POSITION and COLOR_0 are read, other attributes are skipped. Primitives are decoded in parallel.
+bool ImportGltf(const char* path, ImportedMesh& mesh, unsigned int threadCount);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+// Matches the position + color layout the renderer uses (locations 0 and 1, three floats each)
+struct ImportedVertex
+{
+	float x, y, z;
+	float r, g, b;
+};
+
+// One draw range in the cooked file, kept as a triangle soup until the cooker indexes it
+struct ImportedSubMesh
+{
+	std::vector<ImportedVertex> triangles;
+};
+
+struct ImportedMesh
+{
+	std::vector<ImportedSubMesh> subMeshes;
+};
@@ -0,0 +1,280 @@
+#include <cmath>
+#include <limits>
+#include <climits>
+#include <cstring>
+#include <charconv>
+#include <iostream>
+#include "Json.h"
+
+namespace
+{
+	constexpr int maxDepth = 64;
+
+	void SkipWhitespace(const char*& ptr, const char* end)
+	{
+		while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r'))
+		{
+			ptr++;
+		}
+	}
+
+	bool Match(const char*& ptr, const char* end, const char* literal)
+	{
+		size_t length = std::strlen(literal);
+		if (static_cast<size_t>(end - ptr) < length || std::memcmp(ptr, literal, length) != 0)
+		{
+			return false;
+		}
+		ptr += length;
+		return true;
+	}
+}
+
+bool JsonDocument::Parse(const char* text, size_t length)
+{
+	m_Text = text;
+	m_Values.clear();
+	// glTF files average well over 8 bytes per token, this avoids most regrowth
+	m_Values.reserve(length / 8 + 16);
+
+	const char* ptr = text;
+	const char* end = text + length;
+	if (!ParseValue(ptr, end, 0))
+	{
+		std::cerr << "ERROR::JSON::PARSE_FAILED at byte " << (ptr - text) << std::endl;
+		m_Values.clear();
+		return false;
+	}
+
+	SkipWhitespace(ptr, end);
+	if (ptr != end && *ptr != '\0')
+	{
+		std::cerr << "ERROR::JSON::TRAILING_CHARACTERS at byte " << (ptr - text) << std::endl;
+		m_Values.clear();
+		return false;
+	}
+	return true;
+}
+
+bool JsonDocument::ParseString(const char*& ptr, const char* end)
+{
+	// ptr is on the opening quote
+	const char* start = ++ptr;
+	while (ptr < end && *ptr != '"')
+	{
+		ptr += *ptr == '\\' ? 2 : 1;
+	}
+	if (ptr >= end)
+	{
+		return false;
+	}
+
+	m_Values.push_back({ JsonType::String, static_cast<uint32_t>(start - m_Text), static_cast<uint32_t>(ptr - start), 0, 0 });
+	m_Values.back().next = static_cast<uint32_t>(m_Values.size());
+	ptr++;
+	return true;
+}
+
+bool JsonDocument::ParseValue(const char*& ptr, const char* end, int depth)
+{
+	SkipWhitespace(ptr, end);
+	if (ptr >= end || depth > maxDepth)
+	{
+		return false;
+	}
+
+	const char* start = ptr;
+	size_t index = m_Values.size();
+	auto addScalar = [&](JsonType type)
+	{
+		m_Values.push_back({ type, static_cast<uint32_t>(start - m_Text), static_cast<uint32_t>(ptr - start), 0, static_cast<uint32_t>(index + 1) });
+		return true;
+	};
+
+	switch (*ptr)
+	{
+	case '"':
+		return ParseString(ptr, end);
+	case 't':
+		return Match(ptr, end, "true") && addScalar(JsonType::Bool);
+	case 'f':
+		return Match(ptr, end, "false") && addScalar(JsonType::Bool);
+	case 'n':
+		return Match(ptr, end, "null") && addScalar(JsonType::Null);
+	case '[':
+	case '{':
+	{
+		bool isObject = *ptr == '{';
+		char close = isObject ? '}' : ']';
+		m_Values.push_back({ isObject ? JsonType::Object : JsonType::Array, static_cast<uint32_t>(start - m_Text), 0, 0, 0 });
+		ptr++;
+
+		uint32_t childCount = 0;
+		SkipWhitespace(ptr, end);
+		if (ptr < end && *ptr == close)
+		{
+			ptr++;
+		}
+		else
+		{
+			while (true)
+			{
+				if (isObject)
+				{
+					SkipWhitespace(ptr, end);
+					if (ptr >= end || *ptr != '"' || !ParseString(ptr, end))
+					{
+						return false;
+					}
+					SkipWhitespace(ptr, end);
+					if (ptr >= end || *ptr++ != ':')
+					{
+						return false;
+					}
+				}
+				if (!ParseValue(ptr, end, depth + 1))
+				{
+					return false;
+				}
+				childCount++;
+
+				SkipWhitespace(ptr, end);
+				if (ptr >= end)
+				{
+					return false;
+				}
+				if (*ptr == ',')
+				{
+					ptr++;
+					continue;
+				}
+				if (*ptr++ != close)
+				{
+					return false;
+				}
+				break;
+			}
+		}
+
+		JsonValue& value = m_Values[index];
+		value.length = static_cast<uint32_t>(ptr - start);
+		value.childCount = childCount;
+		value.next = static_cast<uint32_t>(m_Values.size());
+		return true;
+	}
+	default:
+	{
+		double number;
+		std::from_chars_result result = std::from_chars(ptr, end, number);
+		if (result.ec != std::errc())
+		{
+			return false;
+		}
+		ptr = result.ptr;
+		return addScalar(JsonType::Number);
+	}
+	}
+}
+
+int JsonDocument::Find(int object, std::string_view key) const
+{
+	if (GetType(object) != JsonType::Object)
+	{
+		return -1;
+	}
+
+	int member = object + 1;
+	for (uint32_t i = 0; i < m_Values[object].childCount; i++)
+	{
+		int value = static_cast<int>(m_Values[member].next);
+		if (GetString(member) == key)
+		{
+			return value;
+		}
+		member = static_cast<int>(m_Values[value].next);
+	}
+	return -1;
+}
+
+int JsonDocument::GetElement(int array, size_t index) const
+{
+	if (GetType(array) != JsonType::Array || index >= m_Values[array].childCount)
+	{
+		return -1;
+	}
+
+	int element = array + 1;
+	for (size_t i = 0; i < index; i++)
+	{
+		element = static_cast<int>(m_Values[element].next);
+	}
+	return element;
+}
+
+int JsonDocument::First(int array) const
+{
+	return GetCount(array) > 0 ? array + 1 : -1;
+}
+
+int JsonDocument::Next(int value) const
+{
+	return value < 0 ? -1 : static_cast<int>(m_Values[value].next);
+}
+
+double JsonDocument::GetNumber(int value, double fallback) const
+{
+	if (GetType(value) != JsonType::Number)
+	{
+		return fallback;
+	}
+
+	double number = fallback;
+	const char* start = m_Text + m_Values[value].start;
+	std::from_chars(start, start + m_Values[value].length, number);
+	return number;
+}
+
+int JsonDocument::GetInt(int value, int fallback) const
+{
+	// Range checked first, casting a double the int can't hold is undefined
+	double number = GetNumber(value, fallback);
+	if (!(number >= INT_MIN && number <= INT_MAX) || number != std::floor(number))
+	{
+		return fallback;
+	}
+	return static_cast<int>(number);
+}
+
+size_t JsonDocument::GetSize(int value, size_t fallback) const
+{
+	if (GetType(value) != JsonType::Number)
+	{
+		return fallback;
+	}
+
+	// 2^64 (or 2^32) is the first double that doesn't fit
+	double number = GetNumber(value);
+	if (!(number >= 0.0 && number < std::ldexp(1.0, std::numeric_limits<size_t>::digits)) || number != std::floor(number))
+	{
+		return SIZE_MAX;
+	}
+	return static_cast<size_t>(number);
+}
+
+bool JsonDocument::GetBool(int value, bool fallback) const
+{
+	if (GetType(value) != JsonType::Bool)
+	{
+		return fallback;
+	}
+	return m_Text[m_Values[value].start] == 't';
+}
+
+std::string_view JsonDocument::GetString(int value) const
+{
+	if (GetType(value) != JsonType::String)
+	{
+		return {};
+	}
+	return std::string_view(m_Text + m_Values[value].start, m_Values[value].length);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+enum class JsonType : uint8_t
+{
+	Null,
+	Bool,
+	Number,
+	String,
+	Array,
+	Object
+};
+
+// One token per value. Object members are stored as a key (String) token followed by the value's tokens.
+struct JsonValue
+{
+	JsonType type;
+	uint32_t start;		// offset into the text, strings exclude the quotes
+	uint32_t length;
+	uint32_t childCount;	// elements of an array, members of an object
+	uint32_t next;		// index of the token after this value's subtree, i.e. the next sibling
+};
+
+// Read only JSON document parsed into a flat token array in one pass, nothing but the token array is allocated.
+// Strings point back into the text and are not unescaped, which is fine for glTF keys and URIs.
+// Values are referred to by token index, -1 means missing.
+class JsonDocument
+{
+public:
+	// text has to outlive the document
+	bool Parse(const char* text, size_t length);
+
+	JsonType GetType(int value) const
+	{
+		return value < 0 ? JsonType::Null : m_Values[value].type;
+	}
+
+	size_t GetCount(int value) const
+	{
+		return value < 0 ? 0 : m_Values[value].childCount;
+	}
+
+	// Member of an object
+	int Find(int object, std::string_view key) const;
+
+	// Element of an array, linear in index since elements vary in size
+	int GetElement(int array, size_t index) const;
+
+	// Walks an array in order, bounded by GetCount():
+	// for (int i = 0, e = First(a); i < count; i++, e = Next(e))
+	int First(int array) const;
+	int Next(int value) const;
+
+	double GetNumber(int value, double fallback = 0.0) const;
+	// Numbers that aren't a whole int come back as fallback
+	int GetInt(int value, int fallback = -1) const;
+	// Byte offsets, lengths and counts. Negative, fractional or too large numbers come back as SIZE_MAX,
+	// so the bounds checks using them fail instead of the cast wrapping around.
+	size_t GetSize(int value, size_t fallback = 0) const;
+	bool GetBool(int value, bool fallback = false) const;
+	std::string_view GetString(int value) const;
+
+	static constexpr int root = 0;
+
+private:
+	bool ParseValue(const char*& ptr, const char* end, int depth);
+	bool ParseString(const char*& ptr, const char* end);
+
+private:
+	const char* m_Text = nullptr;
+	std::vector<JsonValue> m_Values;
+};
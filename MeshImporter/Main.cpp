@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cctype>
+#include "ObjImporter.h"
+#include "GltfImporter.h"
+#include "MeshCooker.h"
+
+// Converts OBJ / glTF / GLB files into the .mesh files OpenGL-Book maps at runtime, so it never parses a text format.
+// Usage: MeshImporter [--threads count] [--output-dir directory] input.obj input.gltf input.glb ...
+int main(int argc, char** argv)
+{
+	unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+	const char* outputDirectory = nullptr;
+	std::vector<const char*> inputs;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+		{
+			threadCount = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--output-dir") == 0 && hasValue)
+		{
+			outputDirectory = argv[++i];
+		}
+		else
+		{
+			inputs.push_back(argv[i]);
+		}
+	}
+
+	if (inputs.empty())
+	{
+		std::cerr << "Usage: MeshImporter [--threads count] [--output-dir directory] input.obj input.gltf input.glb ..." << std::endl;
+		return -1;
+	}
+
+	int failures = 0;
+	for (const char* input : inputs)
+	{
+		std::filesystem::path outputPath = std::filesystem::path(input).replace_extension(".mesh");
+		if (outputDirectory)
+		{
+			outputPath = std::filesystem::path(outputDirectory) / outputPath.filename();
+		}
+
+		std::string extension = std::filesystem::path(input).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c)
+		{
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		});
+
+		auto start = std::chrono::steady_clock::now();
+
+		ImportedMesh mesh;
+		bool isImported = false;
+		if (extension == ".obj")
+		{
+			isImported = ImportObj(input, mesh, threadCount);
+		}
+		else if (extension == ".gltf" || extension == ".glb")
+		{
+			isImported = ImportGltf(input, mesh, threadCount);
+		}
+		else
+		{
+			std::cerr << "ERROR::MESH_IMPORTER::UNKNOWN_FORMAT " << input << std::endl;
+		}
+
+		auto parsed = std::chrono::steady_clock::now();
+
+		CookReport report;
+		if (!isImported || !CookMesh(mesh, outputPath.string().c_str(), threadCount, &report))
+		{
+			std::cerr << "ERROR::MESH_IMPORTER::FAILED " << input << std::endl;
+			failures++;
+			continue;
+		}
+
+		auto cooked = std::chrono::steady_clock::now();
+		std::chrono::duration<double, std::milli> parseTime = parsed - start;
+		std::chrono::duration<double, std::milli> cookTime = cooked - parsed;
+		std::cout << input << " -> " << outputPath.string() << ": " << report.subMeshes << " sub-meshes, "
+			<< report.triangles << " triangles, " << report.inputVertices << " -> " << report.uniqueVertices << " vertices, ACMR "
+			<< report.acmrBefore << " -> " << report.acmrAfter << ", parse " << parseTime.count() << " ms, cook " << cookTime.count() << " ms" << std::endl;
+	}
+
+	return failures ? -1 : 0;
+}
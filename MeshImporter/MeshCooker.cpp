@@ -0,0 +1,102 @@
+#include <cfloat>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "ParallelFor.h"
+#include "MeshCooker.h"
+
+bool CookMesh(const ImportedMesh& mesh, const char* outputPath, unsigned int threadCount, CookReport* report)
+{
+	std::vector<IndexedMesh> indexed(mesh.subMeshes.size());
+	std::vector<MeshOptimizationReport> reports(mesh.subMeshes.size());
+	ParallelFor(mesh.subMeshes.size(), threadCount, [&](size_t i)
+	{
+		const std::vector<ImportedVertex>& triangles = mesh.subMeshes[i].triangles;
+		indexed[i] = OptimizeMesh(triangles.data(), triangles.size(), sizeof(ImportedVertex), &reports[i]);
+	});
+
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (const IndexedMesh& subMesh : indexed)
+	{
+		vertexCount += subMesh.GetVertexCount();
+		indexCount += subMesh.indices.size();
+	}
+	if (vertexCount > UINT32_MAX || indexCount > UINT32_MAX)
+	{
+		return false;
+	}
+
+	// Sub-meshes share one vertex and one index buffer, the indices are rebased as they are appended
+	std::vector<uint8_t> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<MeshFileSubMesh> subMeshes;
+	vertices.reserve(vertexCount * sizeof(ImportedVertex));
+	indices.reserve(indexCount);
+
+	float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (const IndexedMesh& subMesh : indexed)
+	{
+		MeshFileSubMesh fileSubMesh = {};
+		fileSubMesh.firstIndex = static_cast<uint32_t>(indices.size());
+		fileSubMesh.indexCount = static_cast<uint32_t>(subMesh.indices.size());
+		for (int axis = 0; axis < 3; axis++)
+		{
+			fileSubMesh.boundsMin[axis] = FLT_MAX;
+			fileSubMesh.boundsMax[axis] = -FLT_MAX;
+		}
+
+		uint32_t baseVertex = static_cast<uint32_t>(vertices.size() / sizeof(ImportedVertex));
+		for (uint32_t index : subMesh.indices)
+		{
+			indices.push_back(baseVertex + index);
+		}
+
+		for (size_t i = 0; i < subMesh.GetVertexCount(); i++)
+		{
+			ImportedVertex vertex;
+			std::memcpy(&vertex, subMesh.vertices.data() + i * sizeof(ImportedVertex), sizeof(vertex));
+			float position[3] = { vertex.x, vertex.y, vertex.z };
+			for (int axis = 0; axis < 3; axis++)
+			{
+				fileSubMesh.boundsMin[axis] = std::min(fileSubMesh.boundsMin[axis], position[axis]);
+				fileSubMesh.boundsMax[axis] = std::max(fileSubMesh.boundsMax[axis], position[axis]);
+			}
+		}
+		vertices.insert(vertices.end(), subMesh.vertices.begin(), subMesh.vertices.end());
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			boundsMin[axis] = std::min(boundsMin[axis], fileSubMesh.boundsMin[axis]);
+			boundsMax[axis] = std::max(boundsMax[axis], fileSubMesh.boundsMax[axis]);
+		}
+		subMeshes.push_back(fileSubMesh);
+	}
+
+	if (report)
+	{
+		*report = CookReport();
+		report->subMeshes = subMeshes.size();
+		report->uniqueVertices = vertexCount;
+		for (const MeshOptimizationReport& subMeshReport : reports)
+		{
+			report->triangles += subMeshReport.triangles;
+			report->inputVertices += subMeshReport.inputVertices;
+			report->acmrBefore += subMeshReport.acmrBefore * subMeshReport.triangles;
+			report->acmrAfter += subMeshReport.acmrAfter * subMeshReport.triangles;
+		}
+		if (report->triangles)
+		{
+			report->acmrBefore /= report->triangles;
+			report->acmrAfter /= report->triangles;
+		}
+	}
+
+	VertexFormat format;
+	format.Add(0, VertexAttributeFormat::Float3).Add(1, VertexAttributeFormat::Float3);
+	return MeshFile::Write(outputPath, format, vertices.data(), static_cast<uint32_t>(vertexCount),
+		indices.data(), static_cast<uint32_t>(indexCount), boundsMin, boundsMax, std::move(subMeshes));
+}
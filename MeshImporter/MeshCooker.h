@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include "ImportedMesh.h"
+
+struct CookReport
+{
+	size_t subMeshes = 0;
+	size_t triangles = 0;
+	size_t inputVertices = 0;
+	size_t uniqueVertices = 0;
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+};
+
+// Indexes and optimizes every sub-mesh in parallel, concatenates them and writes a MeshFile
+// with the Float3 position + Float3 color layout
+bool CookMesh(const ImportedMesh& mesh, const char* outputPath, unsigned int threadCount, CookReport* report = nullptr);
@@ -0,0 +1,250 @@
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <charconv>
+#include <iostream>
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "ObjImporter.h"
+
+namespace
+{
+	// A face corner before the chunks are stitched together. Positive OBJ indices are absolute,
+	// negative ones count back from the vertices seen so far and are only known relative to their chunk.
+	struct FaceCorner
+	{
+		int64_t index;
+		bool isChunkRelative;
+	};
+
+	struct Chunk
+	{
+		const char* begin;
+		const char* end;
+		std::vector<ImportedVertex> vertices;
+		std::vector<FaceCorner> corners;	// three per triangle
+		size_t firstVertex = 0;
+		size_t firstCorner = 0;
+		size_t badLines = 0;
+	};
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	void SkipSpaces(const char*& ptr, const char* end)
+	{
+		while (ptr < end && IsSpace(*ptr))
+		{
+			ptr++;
+		}
+	}
+
+	const char* FindLineEnd(const char* ptr, const char* end)
+	{
+		while (ptr < end && *ptr != '\n')
+		{
+			ptr++;
+		}
+		return ptr;
+	}
+
+	bool ParseFloat(const char*& ptr, const char* end, float& value)
+	{
+		SkipSpaces(ptr, end);
+		std::from_chars_result result = std::from_chars(ptr, end, value);
+		if (result.ec != std::errc())
+		{
+			return false;
+		}
+		ptr = result.ptr;
+		return true;
+	}
+
+	// Parses "v", "v/vt", "v//vn" or "v/vt/vn" and keeps only the position index
+	bool ParseCorner(const char*& ptr, const char* end, size_t chunkVertexCount, FaceCorner& corner)
+	{
+		SkipSpaces(ptr, end);
+		int64_t index;
+		std::from_chars_result result = std::from_chars(ptr, end, index);
+		if (result.ec != std::errc() || index == 0)
+		{
+			return false;
+		}
+		ptr = result.ptr;
+		while (ptr < end && !IsSpace(*ptr))
+		{
+			ptr++;
+		}
+
+		if (index > 0)
+		{
+			corner = { index - 1, false };
+		}
+		else
+		{
+			corner = { static_cast<int64_t>(chunkVertexCount) + index, true };
+		}
+		return true;
+	}
+
+	void ParseChunk(Chunk& chunk)
+	{
+		// Rough guesses so most chunks never regrow
+		size_t size = chunk.end - chunk.begin;
+		chunk.vertices.reserve(size / 64);
+		chunk.corners.reserve(size / 16);
+
+		FaceCorner polygon[3];
+		for (const char* line = chunk.begin; line < chunk.end;)
+		{
+			const char* lineEnd = FindLineEnd(line, chunk.end);
+			const char* ptr = line;
+			line = lineEnd + 1;
+
+			SkipSpaces(ptr, lineEnd);
+			if (lineEnd - ptr < 2 || !IsSpace(ptr[1]))
+			{
+				continue;
+			}
+
+			if (ptr[0] == 'v')
+			{
+				ptr++;
+				ImportedVertex vertex = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+				if (!ParseFloat(ptr, lineEnd, vertex.x) || !ParseFloat(ptr, lineEnd, vertex.y) || !ParseFloat(ptr, lineEnd, vertex.z))
+				{
+					chunk.badLines++;
+				}
+				// Optional vertex color extension, anything else after xyz (e.g. w) is ignored
+				float r, g, b;
+				if (ParseFloat(ptr, lineEnd, r) && ParseFloat(ptr, lineEnd, g) && ParseFloat(ptr, lineEnd, b))
+				{
+					vertex.r = r;
+					vertex.g = g;
+					vertex.b = b;
+				}
+				chunk.vertices.push_back(vertex);
+			}
+			else if (ptr[0] == 'f')
+			{
+				ptr++;
+				// Fan triangulation: (0, 1, 2), (0, 2, 3), ...
+				int cornerCount = 0;
+				FaceCorner corner;
+				while (ParseCorner(ptr, lineEnd, chunk.vertices.size(), corner))
+				{
+					if (cornerCount < 3)
+					{
+						polygon[cornerCount] = corner;
+					}
+					else
+					{
+						polygon[1] = polygon[2];
+						polygon[2] = corner;
+					}
+					cornerCount++;
+
+					if (cornerCount >= 3)
+					{
+						chunk.corners.insert(chunk.corners.end(), polygon, polygon + 3);
+					}
+				}
+				if (cornerCount < 3)
+				{
+					chunk.badLines++;
+				}
+			}
+		}
+	}
+}
+
+bool ImportObj(const char* path, ImportedMesh& mesh, unsigned int threadCount)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	const char* text = reinterpret_cast<const char*>(file.GetData());
+	const char* textEnd = text + file.GetSize();
+
+	// Small files are not worth the threads
+	constexpr size_t minChunkSize = 1 << 20;
+	size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, file.GetSize() / minChunkSize));
+	std::vector<Chunk> chunks(chunkCount);
+	const char* chunkBegin = text;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char* chunkEnd = i + 1 == chunkCount ? textEnd : FindLineEnd(text + file.GetSize() * (i + 1) / chunkCount, textEnd);
+		chunks[i].begin = chunkBegin;
+		chunks[i].end = std::max(chunkBegin, std::min(chunkEnd + (chunkEnd < textEnd ? 1 : 0), textEnd));
+		chunkBegin = chunks[i].end;
+	}
+
+	ParallelFor(chunkCount, threadCount, [&chunks](size_t i)
+	{
+		ParseChunk(chunks[i]);
+	});
+
+	size_t vertexCount = 0;
+	size_t cornerCount = 0;
+	size_t badLines = 0;
+	for (Chunk& chunk : chunks)
+	{
+		chunk.firstVertex = vertexCount;
+		chunk.firstCorner = cornerCount;
+		vertexCount += chunk.vertices.size();
+		cornerCount += chunk.corners.size();
+		badLines += chunk.badLines;
+	}
+
+	if (badLines)
+	{
+		std::cerr << "WARNING::OBJ_IMPORTER::SKIPPED_LINES " << badLines << " in " << path << std::endl;
+	}
+	if (cornerCount == 0)
+	{
+		std::cerr << "ERROR::OBJ_IMPORTER::NO_FACES " << path << std::endl;
+		return false;
+	}
+
+	// Resolve every corner into one preallocated soup, each chunk writes its own range
+	mesh.subMeshes.resize(1);
+	std::vector<ImportedVertex>& triangles = mesh.subMeshes[0].triangles;
+	triangles.resize(cornerCount);
+
+	std::atomic<size_t> badIndices = 0;
+	ParallelFor(chunkCount, threadCount, [&](size_t i)
+	{
+		const Chunk& chunk = chunks[i];
+		ImportedVertex* output = triangles.data() + chunk.firstCorner;
+		for (const FaceCorner& corner : chunk.corners)
+		{
+			int64_t index = corner.isChunkRelative ? corner.index + static_cast<int64_t>(chunk.firstVertex) : corner.index;
+			if (index < 0 || index >= static_cast<int64_t>(vertexCount))
+			{
+				badIndices++;
+				*output++ = {};
+				continue;
+			}
+
+			size_t chunkIndex = chunkCount - 1;
+			while (static_cast<size_t>(index) < chunks[chunkIndex].firstVertex)
+			{
+				chunkIndex--;
+			}
+			*output++ = chunks[chunkIndex].vertices[index - chunks[chunkIndex].firstVertex];
+		}
+	});
+
+	if (badIndices)
+	{
+		std::cerr << "ERROR::OBJ_IMPORTER::INDEX_OUT_OF_RANGE " << badIndices << " corners in " << path << std::endl;
+		return false;
+	}
+	return true;
+}
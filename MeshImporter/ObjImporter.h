@@ -0,0 +1,8 @@
+#pragma once
+
+#include "ImportedMesh.h"
+
+// Wavefront OBJ: positions, optional vertex colors ("v x y z r g b") and polygonal faces, which are fan triangulated.
+// Texture coordinates, normals and materials are skipped since the target layout has no use for them.
+// The file is mapped and split into threadCount chunks at line boundaries that are parsed in parallel.
+bool ImportObj(const char* path, ImportedMesh& mesh, unsigned int threadCount);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Runs function(i) for every i in [0, count) on up to threadCount threads, the calling thread included.
+// Items are handed out one at a time so uneven items still balance.
+template<typename Function>
+void ParallelFor(size_t count, unsigned int threadCount, Function function)
+{
+	std::atomic<size_t> nextItem = 0;
+	auto worker = [&]()
+	{
+		for (size_t i = nextItem++; i < count; i = nextItem++)
+		{
+			function(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < threadCount && i < count; i++)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
@@ -0,0 +1,126 @@
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include "Profiler.h"
+#include "BatchRenderer.h"
+
+BatchRenderer::BatchRenderer(unsigned int maxVertices)
+	: m_MaxVertices(maxVertices - maxVertices % 3), m_Stream(GL_ARRAY_BUFFER, m_MaxVertices * sizeof(BatchVertex))
+{
+	glGenVertexArrays(1, &m_VAO);
+
+	GLState::BindVertexArray(m_VAO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_Stream.GetBuffer());
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, x));
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, r));
+	glEnableVertexAttribArray(1);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+	GLState::OnVertexArrayDeleted(m_VAO);
+	glDeleteVertexArrays(1, &m_VAO);
+}
+
+std::vector<BatchVertex>& BatchRenderer::GetBucket(const ShaderProgram& program)
+{
+	if (m_LastBucket < m_Buckets.size() && m_Buckets[m_LastBucket].program == &program)
+	{
+		return m_Buckets[m_LastBucket].vertices;
+	}
+
+	auto it = std::find_if(m_Buckets.begin(), m_Buckets.end(), [&program](const Bucket& bucket)
+	{
+		return bucket.program == &program;
+	});
+	if (it == m_Buckets.end())
+	{
+		m_Buckets.push_back({ &program, {} });
+		it = m_Buckets.end() - 1;
+	}
+
+	m_LastBucket = it - m_Buckets.begin();
+	return it->vertices;
+}
+
+void BatchRenderer::SubmitTriangle(const ShaderProgram& program, const BatchVertex& a, const BatchVertex& b, const BatchVertex& c)
+{
+	std::vector<BatchVertex>& vertices = GetBucket(program);
+	vertices.push_back(a);
+	vertices.push_back(b);
+	vertices.push_back(c);
+}
+
+void BatchRenderer::SubmitQuad(const ShaderProgram& program, const BatchVertex& a, const BatchVertex& b, const BatchVertex& c, const BatchVertex& d)
+{
+	std::vector<BatchVertex>& vertices = GetBucket(program);
+	vertices.push_back(a);
+	vertices.push_back(b);
+	vertices.push_back(c);
+	vertices.push_back(a);
+	vertices.push_back(c);
+	vertices.push_back(d);
+}
+
+void BatchRenderer::Flush()
+{
+	PROFILE_FUNCTION();
+
+	m_Stats = BatchStats();
+	GLState::BindVertexArray(m_VAO);
+
+	// Every chunk is written straight into the stream buffer and drawn from there, a bucket that doesn't fit in
+	// what is left of the current region continues in the next one
+	for (Bucket& bucket : m_Buckets)
+	{
+		if (!bucket.program->IsLinked())
+		{
+			bucket.vertices.clear();
+			continue;
+		}
+
+		size_t uploaded = 0;
+		// A fresh region that still can't take a triangle never will, e.g. when the persistent map failed
+		bool isFreshRegion = false;
+		while (uploaded < bucket.vertices.size())
+		{
+			size_t space = m_Stream.GetRemainingSize() / sizeof(BatchVertex);
+			size_t count = std::min(bucket.vertices.size() - uploaded, space - space % 3);
+			StreamAllocation allocation;
+			if (count > 0)
+			{
+				allocation = m_Stream.Map(count * sizeof(BatchVertex), sizeof(BatchVertex));
+			}
+			if (!allocation.data)
+			{
+				if (isFreshRegion)
+				{
+					std::cerr << "ERROR::BATCH_RENDERER::CANNOT_MAP_STREAM dropped " << (bucket.vertices.size() - uploaded) / 3 << " triangles" << std::endl;
+					break;
+				}
+				m_Stream.NextRegion();
+				isFreshRegion = true;
+				continue;
+			}
+			isFreshRegion = false;
+
+			std::memcpy(allocation.data, bucket.vertices.data() + uploaded, count * sizeof(BatchVertex));
+			m_Stream.Unmap();
+
+			bucket.program->Use();
+			glDrawArrays(GL_TRIANGLES, static_cast<GLint>(allocation.offset / sizeof(BatchVertex)), static_cast<GLsizei>(count));
+
+			m_Stats.drawCalls++;
+			m_Stats.vertices += static_cast<unsigned int>(count);
+			uploaded += count;
+		}
+
+		bucket.vertices.clear();
+	}
+
+	m_Stream.NextRegion();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include "ShaderProgram.h"
+#include "StreamBuffer.h"
+
+// Same interleaved layout as the triangle in Main.cpp: position at location 0, color at location 1
+struct BatchVertex
+{
+	float x, y, z;
+	float r, g, b;
+};
+
+struct BatchStats
+{
+	unsigned int drawCalls = 0;
+	unsigned int vertices = 0;
+};
+
+// Collects triangles and quads on the CPU and draws everything that uses the same program with one glDrawArrays.
+// Submissions are bucketed per program as they come in, so Flush() is already sorted and never has to sort.
+// Call Flush() once per frame, the vertices stream through a fenced ring buffer so uploads never wait on the GPU.
+class BatchRenderer
+{
+public:
+	// maxVertices is per frame, the stream buffer holds three frames worth
+	explicit BatchRenderer(unsigned int maxVertices = 3 * 65536);
+	~BatchRenderer();
+
+	BatchRenderer(const BatchRenderer&) = delete;
+	BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+	void SubmitTriangle(const ShaderProgram& program, const BatchVertex& a, const BatchVertex& b, const BatchVertex& c);
+
+	// Corners in order around the quad, split into the triangles abc and acd
+	void SubmitQuad(const ShaderProgram& program, const BatchVertex& a, const BatchVertex& b, const BatchVertex& c, const BatchVertex& d);
+
+	// Uploads and draws everything submitted since the last flush
+	void Flush();
+
+	// Counters of the last Flush()
+	const BatchStats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+private:
+	struct Bucket
+	{
+		const ShaderProgram* program;
+		std::vector<BatchVertex> vertices;
+	};
+
+	std::vector<BatchVertex>& GetBucket(const ShaderProgram& program);
+
+private:
+	unsigned int m_VAO = 0;
+	unsigned int m_MaxVertices;
+	StreamBuffer m_Stream;
+
+	// Buckets are kept (and their memory reused) across frames, empty ones are skipped
+	std::vector<Bucket> m_Buckets;
+	// Consecutive submissions usually use the same program, remember the last bucket to skip the search
+	size_t m_LastBucket = 0;
+
+	BatchStats m_Stats;
+};
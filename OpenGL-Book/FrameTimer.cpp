@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <glad/glad.h>
+#include "FrameTimer.h"
+
+void RollingStats::Add(double value)
+{
+	if (m_Samples.size() < windowSize)
+	{
+		m_Samples.push_back(value);
+		return;
+	}
+	m_Samples[m_Next] = value;
+	m_Next = (m_Next + 1) % windowSize;
+}
+
+double RollingStats::GetMin() const
+{
+	return m_Samples.empty() ? 0.0 : *std::min_element(m_Samples.begin(), m_Samples.end());
+}
+
+double RollingStats::GetAverage() const
+{
+	if (m_Samples.empty())
+	{
+		return 0.0;
+	}
+
+	double sum = 0.0;
+	for (double sample : m_Samples)
+	{
+		sum += sample;
+	}
+	return sum / m_Samples.size();
+}
+
+double RollingStats::GetP99() const
+{
+	if (m_Samples.empty())
+	{
+		return 0.0;
+	}
+
+	std::vector<double> sorted = m_Samples;
+	size_t index = (sorted.size() * 99) / 100;
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+FrameTimer::FrameTimer()
+{
+	glGenQueries(queryCount, m_Queries);
+}
+
+FrameTimer::~FrameTimer()
+{
+	glDeleteQueries(queryCount, m_Queries);
+}
+
+void FrameTimer::BeginFrame()
+{
+	Clock::time_point now = Clock::now();
+	if (m_HasPreviousFrame)
+	{
+		m_FrameTimes[CpuFrame] = std::chrono::duration<double, std::milli>(now - m_FrameStart).count();
+		m_Stats[CpuFrame].Add(m_FrameTimes[CpuFrame]);
+	}
+
+	m_HasPreviousFrame = true;
+	m_FrameStart = now;
+	m_PhaseStart = now;
+}
+
+void FrameTimer::EndPhase(Metric metric)
+{
+	Clock::time_point now = Clock::now();
+	m_FrameTimes[metric] = std::chrono::duration<double, std::milli>(now - m_PhaseStart).count();
+	m_Stats[metric].Add(m_FrameTimes[metric]);
+	m_PhaseStart = now;
+}
+
+void FrameTimer::SetPhase(Metric metric, Clock::time_point begin, Clock::time_point end)
+{
+	m_FrameTimes[metric] = std::chrono::duration<double, std::milli>(end - begin).count();
+	m_Stats[metric].Add(m_FrameTimes[metric]);
+	m_PhaseStart = Clock::now();
+}
+
+void FrameTimer::SetStateStats(const GLStateStats& stats)
+{
+	m_StateStats = stats;
+	m_TotalIssued += stats.issued;
+	m_TotalSkipped += stats.skipped;
+}
+
+void FrameTimer::EndFrame()
+{
+	CollectGpuResults();
+
+	// The frame time of this frame is only known once the next one starts, so the row carries the previous frame's total
+	if (m_Csv.is_open())
+	{
+		m_Csv << m_FrameIndex;
+		for (int metric = 0; metric < MetricCount; metric++)
+		{
+			m_Csv << "," << m_FrameTimes[metric];
+		}
+		m_Csv << "," << m_StateStats.issued << "," << m_StateStats.skipped << "\n";
+	}
+
+	m_StateStats = GLStateStats();
+	m_FrameIndex++;
+}
+
+void FrameTimer::BeginGpu()
+{
+	// Every query is still in flight, skip this frame rather than wait for the GPU
+	if (m_PendingQueries == queryCount)
+	{
+		return;
+	}
+
+	int query = (m_QueryHead + m_PendingQueries) % queryCount;
+	glBeginQuery(GL_TIME_ELAPSED, m_Queries[query]);
+	m_IsGpuQueryActive = true;
+}
+
+void FrameTimer::EndGpu()
+{
+	if (!m_IsGpuQueryActive)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_IsGpuQueryActive = false;
+	m_PendingQueries++;
+}
+
+void FrameTimer::CollectGpuResults()
+{
+	// Queries finish in order, stop at the first one that isn't done
+	while (m_PendingQueries > 0)
+	{
+		unsigned int query = m_Queries[m_QueryHead];
+		int isAvailable = 0;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+		if (!isAvailable)
+		{
+			break;
+		}
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		m_FrameTimes[Gpu] = elapsed / 1.0e6;
+		m_Stats[Gpu].Add(m_FrameTimes[Gpu]);
+
+		m_QueryHead = (m_QueryHead + 1) % queryCount;
+		m_PendingQueries--;
+	}
+}
+
+void FrameTimer::Print(std::ostream& stream) const
+{
+	for (int metric = 0; metric < MetricCount; metric++)
+	{
+		const RollingStats& stats = m_Stats[metric];
+		stream << GetMetricName(static_cast<Metric>(metric))
+			<< " min: " << stats.GetMin()
+			<< " avg: " << stats.GetAverage()
+			<< " p99: " << stats.GetP99() << " ms\n";
+	}
+
+	// Averaged over every frame so far, not just the window
+	if (m_FrameIndex > 0)
+	{
+		unsigned long long total = m_TotalIssued + m_TotalSkipped;
+		stream << "gl_state issued: " << static_cast<double>(m_TotalIssued) / m_FrameIndex
+			<< " skipped: " << static_cast<double>(m_TotalSkipped) / m_FrameIndex << " per frame ("
+			<< (total ? 100.0 * m_TotalSkipped / total : 0.0) << "% skipped)\n";
+	}
+	stream.flush();
+}
+
+bool FrameTimer::OpenCsv(const char* path)
+{
+	m_Csv.open(path, std::ios::trunc);
+	if (!m_Csv)
+	{
+		return false;
+	}
+
+	m_Csv << "frame";
+	for (int metric = 0; metric < MetricCount; metric++)
+	{
+		m_Csv << "," << GetMetricName(static_cast<Metric>(metric)) << "_ms";
+	}
+	m_Csv << ",gl_state_issued,gl_state_skipped\n";
+	return true;
+}
+
+const char* FrameTimer::GetMetricName(Metric metric)
+{
+	switch (metric)
+	{
+	case CpuFrame: return "cpu_frame";
+	case CpuInput: return "cpu_input";
+	case CpuRecord: return "cpu_record";
+	case CpuDraw: return "cpu_draw";
+	case CpuSwap: return "cpu_swap";
+	case Gpu: return "gpu";
+	default: return "unknown";
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include "GLState.h"
+
+// Min / average / 99th percentile over the last windowSize samples
+class RollingStats
+{
+public:
+	static constexpr size_t windowSize = 240;
+
+	void Add(double value);
+
+	double GetMin() const;
+	double GetAverage() const;
+	double GetP99() const;
+
+	size_t GetCount() const
+	{
+		return m_Samples.size();
+	}
+
+private:
+	std::vector<double> m_Samples;
+	size_t m_Next = 0;
+};
+
+// Per frame CPU timings for each part of the loop plus GPU time from GL_TIME_ELAPSED queries.
+// The GPU queries live in a small ring and are read back a few frames later, so timing never stalls the pipeline.
+class FrameTimer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum Metric
+	{
+		CpuFrame,	// loop start to loop start
+		CpuInput,	// input handling
+		CpuRecord,	// recording the scene, jobs it waits on included
+		CpuDraw,	// draw submission, not execution
+		CpuSwap,
+		Gpu,		// between BeginGpu() and EndGpu(), arrives a few frames late
+		MetricCount
+	};
+
+	FrameTimer();
+	~FrameTimer();
+
+	FrameTimer(const FrameTimer&) = delete;
+	FrameTimer& operator=(const FrameTimer&) = delete;
+
+	void BeginFrame();
+	// Ends the metric's phase, phases run back to back from BeginFrame() or the last SetPhase()
+	void EndPhase(Metric metric);
+	// A phase timed by the thread that ran it, e.g. input and recording while a render thread draws. The next phase starts now.
+	void SetPhase(Metric metric, Clock::time_point begin, Clock::time_point end);
+	// Redundant state counters of the frame, call before EndFrame() with what GLState::EndFrame() returned
+	void SetStateStats(const GLStateStats& stats);
+	void EndFrame();
+
+	void BeginGpu();
+	void EndGpu();
+
+	// Times are in milliseconds
+	const RollingStats& GetStats(Metric metric) const
+	{
+		return m_Stats[metric];
+	}
+
+	void Print(std::ostream& stream) const;
+
+	// Writes one row per frame from now on
+	bool OpenCsv(const char* path);
+
+	static const char* GetMetricName(Metric metric);
+
+private:
+	static constexpr int queryCount = 4;
+
+	void CollectGpuResults();
+
+private:
+	RollingStats m_Stats[MetricCount];
+	double m_FrameTimes[MetricCount] = {};
+	long long m_FrameIndex = 0;
+
+	GLStateStats m_StateStats;
+	unsigned long long m_TotalIssued = 0;
+	unsigned long long m_TotalSkipped = 0;
+
+	Clock::time_point m_FrameStart;
+	Clock::time_point m_PhaseStart;
+	bool m_HasPreviousFrame = false;
+
+	unsigned int m_Queries[queryCount] = {};
+	// Ring of submitted queries that haven't been read back yet
+	int m_QueryHead = 0;
+	int m_PendingQueries = 0;
+	bool m_IsGpuQueryActive = false;
+
+	std::ofstream m_Csv;
+};
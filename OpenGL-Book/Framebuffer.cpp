@@ -0,0 +1,53 @@
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include "Framebuffer.h"
+
+Framebuffer::Framebuffer(int width, int height)
+	: m_Width(width), m_Height(height)
+{
+	glGenRenderbuffers(1, &m_ColorRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_ColorRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenFramebuffers(1, &m_Framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorRenderbuffer);
+
+	m_IsComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!m_IsComplete)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+	}
+}
+
+Framebuffer::~Framebuffer()
+{
+	glDeleteFramebuffers(1, &m_Framebuffer);
+	glDeleteRenderbuffers(1, &m_ColorRenderbuffer);
+}
+
+bool Framebuffer::WritePPM(const char* path) const
+{
+	std::vector<unsigned char> pixels(static_cast<size_t>(m_Width) * m_Height * 3);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_Width, m_Height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "ERROR::FRAMEBUFFER::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+
+	// GL's origin is the bottom left, PPM's is the top left
+	file << "P6\n" << m_Width << " " << m_Height << "\n255\n";
+	size_t rowSize = static_cast<size_t>(m_Width) * 3;
+	for (int y = m_Height - 1; y >= 0; y--)
+	{
+		file.write(reinterpret_cast<const char*>(pixels.data() + y * rowSize), rowSize);
+	}
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Offscreen render target with a single RGBA8 color attachment
+class Framebuffer
+{
+public:
+	Framebuffer(int width, int height);
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	bool IsComplete() const
+	{
+		return m_IsComplete;
+	}
+
+	void Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+	}
+
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+
+	// Reads the color attachment back and writes it as a binary PPM, handy to check what a headless run rendered
+	bool WritePPM(const char* path) const;
+
+private:
+	unsigned int m_Framebuffer = 0;
+	unsigned int m_ColorRenderbuffer = 0;
+	int m_Width;
+	int m_Height;
+	bool m_IsComplete = false;
+};
@@ -0,0 +1,249 @@
+#include <limits>
+#include "GLState.h"
+
+namespace
+{
+	// Never a valid value for any of the tracked state, so the first call always goes through
+	constexpr unsigned int unknownName = 0xFFFFFFFF;
+	constexpr GLenum unknownEnum = 0xFFFFFFFF;
+}
+
+thread_local GLState::State GLState::s_State = []()
+{
+	GLState::State state = {};
+	Reset(state);
+	return state;
+}();
+
+void GLState::UseProgram(unsigned int program)
+{
+	if (s_State.program == program && Skip())
+	{
+		return;
+	}
+	Issue();
+	s_State.program = program;
+	glUseProgram(program);
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+	if (s_State.vertexArray == vertexArray && Skip())
+	{
+		return;
+	}
+	Issue();
+	s_State.vertexArray = vertexArray;
+	glBindVertexArray(vertexArray);
+}
+
+void GLState::BindBuffer(GLenum target, unsigned int buffer)
+{
+	int slot = GetBufferSlot(target);
+	if (slot < 0)
+	{
+		// Untracked target (e.g. GL_ELEMENT_ARRAY_BUFFER), always forward it
+		Issue();
+		glBindBuffer(target, buffer);
+		return;
+	}
+
+	if (s_State.buffers[slot] == buffer && Skip())
+	{
+		return;
+	}
+	Issue();
+	s_State.buffers[slot] = buffer;
+	glBindBuffer(target, buffer);
+}
+
+void GLState::BindBufferRange(GLenum target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+{
+	if (target == GL_UNIFORM_BUFFER && index < trackedUniformBindings)
+	{
+		BufferRange& binding = s_State.uniformBindings[index];
+		if (binding.buffer == buffer && binding.offset == offset && binding.size == size && Skip())
+		{
+			return;
+		}
+		binding = { buffer, offset, size };
+	}
+
+	Issue();
+	int slot = GetBufferSlot(target);
+	if (slot >= 0)
+	{
+		s_State.buffers[slot] = buffer;
+	}
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLState::PolygonMode(GLenum mode)
+{
+	if (s_State.polygonMode == mode && Skip())
+	{
+		return;
+	}
+	Issue();
+	s_State.polygonMode = mode;
+	glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GLState::ClearColor(float r, float g, float b, float a)
+{
+	float* color = s_State.clearColor;
+	if (color[0] == r && color[1] == g && color[2] == b && color[3] == a && Skip())
+	{
+		return;
+	}
+	Issue();
+	color[0] = r;
+	color[1] = g;
+	color[2] = b;
+	color[3] = a;
+	glClearColor(r, g, b, a);
+}
+
+void GLState::Viewport(int x, int y, int width, int height)
+{
+	int* viewport = s_State.viewport;
+	if (viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height && Skip())
+	{
+		return;
+	}
+	Issue();
+	viewport[0] = x;
+	viewport[1] = y;
+	viewport[2] = width;
+	viewport[3] = height;
+	glViewport(x, y, width, height);
+}
+
+void GLState::BindTexture(unsigned int unit, GLenum target, unsigned int texture)
+{
+	bool isTracked = target == GL_TEXTURE_2D && unit < trackedTextureUnits;
+	if (isTracked && s_State.textures[unit] == texture && Skip())
+	{
+		return;
+	}
+
+	ActiveTexture(unit);
+	Issue();
+	if (isTracked)
+	{
+		s_State.textures[unit] = texture;
+	}
+	glBindTexture(target, texture);
+}
+
+void GLState::ActiveTexture(unsigned int unit)
+{
+	if (s_State.activeTextureUnit == unit && Skip())
+	{
+		return;
+	}
+	Issue();
+	s_State.activeTextureUnit = unit;
+	glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLState::OnProgramDeleted(unsigned int program)
+{
+	if (s_State.program == program)
+	{
+		s_State.program = unknownName;
+	}
+}
+
+void GLState::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+	if (s_State.vertexArray == vertexArray)
+	{
+		s_State.vertexArray = unknownName;
+	}
+}
+
+void GLState::OnBufferDeleted(unsigned int buffer)
+{
+	for (unsigned int& bound : s_State.buffers)
+	{
+		if (bound == buffer)
+		{
+			bound = unknownName;
+		}
+	}
+	for (BufferRange& binding : s_State.uniformBindings)
+	{
+		if (binding.buffer == buffer)
+		{
+			binding.buffer = unknownName;
+		}
+	}
+}
+
+void GLState::OnTextureDeleted(unsigned int texture)
+{
+	for (unsigned int& bound : s_State.textures)
+	{
+		if (bound == texture)
+		{
+			bound = unknownName;
+		}
+	}
+}
+
+void GLState::Invalidate()
+{
+	Reset(s_State);
+}
+
+void GLState::Reset(State& state)
+{
+	state.program = unknownName;
+	state.vertexArray = unknownName;
+	for (unsigned int& buffer : state.buffers)
+	{
+		buffer = unknownName;
+	}
+	for (BufferRange& binding : state.uniformBindings)
+	{
+		binding = { unknownName, 0, 0 };
+	}
+	state.activeTextureUnit = unknownName;
+	for (unsigned int& texture : state.textures)
+	{
+		texture = unknownName;
+	}
+	state.polygonMode = unknownEnum;
+	// NaN never compares equal, so the first ClearColor() always goes through
+	for (float& channel : state.clearColor)
+	{
+		channel = std::numeric_limits<float>::quiet_NaN();
+	}
+	for (int& value : state.viewport)
+	{
+		value = -1;
+	}
+}
+
+GLStateStats GLState::EndFrame()
+{
+	GLStateStats stats = s_State.frameStats;
+	s_State.frameStats = GLStateStats();
+	return stats;
+}
+
+int GLState::GetBufferSlot(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: return ArrayBufferSlot;
+	case GL_COPY_READ_BUFFER: return CopyReadBufferSlot;
+	case GL_COPY_WRITE_BUFFER: return CopyWriteBufferSlot;
+	case GL_PIXEL_PACK_BUFFER: return PixelPackBufferSlot;
+	case GL_PIXEL_UNPACK_BUFFER: return PixelUnpackBufferSlot;
+	case GL_UNIFORM_BUFFER: return UniformBufferSlot;
+	case GL_DRAW_INDIRECT_BUFFER: return DrawIndirectBufferSlot;
+	default: return -1;
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Redundant state change counters for one frame
+struct GLStateStats
+{
+	unsigned int issued = 0;
+	unsigned int skipped = 0;
+};
+
+// Shadows the bits of GL state the renderer touches and drops calls that wouldn't change anything.
+// The cache is per thread because a GL context is only ever current on one thread at a time,
+// anything that changes state behind its back has to call Invalidate().
+class GLState
+{
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+	static void BindBuffer(GLenum target, unsigned int buffer);
+	// Indexed GL_UNIFORM_BUFFER bindings are tracked, other targets are forwarded. Also binds the generic target like GL does.
+	static void BindBufferRange(GLenum target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size);
+	static void PolygonMode(GLenum mode);
+	static void ClearColor(float r, float g, float b, float a);
+	static void Viewport(int x, int y, int width, int height);
+	// unit is the index, not GL_TEXTURE0 + index. GL_TEXTURE_2D bindings of the first units are tracked, the rest is forwarded.
+	static void BindTexture(unsigned int unit, GLenum target, unsigned int texture);
+	static void ActiveTexture(unsigned int unit);
+
+	// GL reuses names, so a deleted object has to be forgotten or a new one with the same name gets skipped
+	static void OnProgramDeleted(unsigned int program);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnBufferDeleted(unsigned int buffer);
+	static void OnTextureDeleted(unsigned int texture);
+
+	// Forget everything, the next call of each kind always reaches the driver
+	static void Invalidate();
+
+	// Returns the counters of the frame that just ended and starts counting the next one
+	static GLStateStats EndFrame();
+
+	static const GLStateStats& GetFrameStats()
+	{
+		return s_State.frameStats;
+	}
+
+private:
+	// Targets that are global context state. GL_ELEMENT_ARRAY_BUFFER is not in here on purpose, it lives in the VAO
+	enum BufferSlot
+	{
+		ArrayBufferSlot,
+		CopyReadBufferSlot,
+		CopyWriteBufferSlot,
+		PixelPackBufferSlot,
+		PixelUnpackBufferSlot,
+		UniformBufferSlot,
+		DrawIndirectBufferSlot,
+		BufferSlotCount
+	};
+
+	// GL guarantees at least 36 combined uniform buffer bindings, the renderer uses far fewer
+	static constexpr unsigned int trackedUniformBindings = 16;
+	// Same for texture units, GL guarantees at least 16 per shader stage
+	static constexpr unsigned int trackedTextureUnits = 16;
+
+	struct BufferRange
+	{
+		unsigned int buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	struct State
+	{
+		unsigned int program;
+		unsigned int vertexArray;
+		unsigned int buffers[BufferSlotCount];
+		BufferRange uniformBindings[trackedUniformBindings];
+		unsigned int activeTextureUnit;
+		unsigned int textures[trackedTextureUnits];
+		GLenum polygonMode;
+		float clearColor[4];
+		int viewport[4];
+
+		GLStateStats frameStats;
+	};
+
+	static void Reset(State& state);
+	static int GetBufferSlot(GLenum target);
+
+	static bool Skip()
+	{
+		s_State.frameStats.skipped++;
+		return true;
+	}
+
+	static void Issue()
+	{
+		s_State.frameStats.issued++;
+	}
+
+private:
+	static thread_local State s_State;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// FNV-1a, constexpr so string literals can be hashed at compile time
+constexpr uint32_t HashString(const char* str, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= static_cast<unsigned char>(str[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+constexpr uint32_t HashString(const char* str)
+{
+	uint32_t hash = 2166136261u;
+	while (*str)
+	{
+		hash ^= static_cast<unsigned char>(*str++);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// 64-bit FNV-1a for hashing larger blobs (shader sources) where 32 bits would collide too easily
+inline uint64_t HashBytes64(const void* data, size_t length, uint64_t hash = 14695981039346656037ull)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
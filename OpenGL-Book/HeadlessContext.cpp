@@ -0,0 +1,195 @@
+#include <cstring>
+#include <iostream>
+#include "HeadlessContext.h"
+
+#ifdef HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+#ifdef HEADLESS_EGL
+
+HeadlessContext::HeadlessContext(int width, int height)
+{
+	// Prefer Mesa's surfaceless platform, it needs neither X11 nor a DRM device
+	EGLDisplay display = EGL_NO_DISPLAY;
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (getPlatformDisplay && clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless"))
+	{
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (display == EGL_NO_DISPLAY)
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cerr << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED" << std::endl;
+		return;
+	}
+	m_Display = display;
+
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+	{
+		// Surfaceless displays may not expose pbuffer configs, we don't need one anyway
+		const EGLint surfacelessConfigAttribs[] = { EGL_SURFACE_TYPE, 0, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		if (!eglChooseConfig(display, surfacelessConfigAttribs, &config, 1, &configCount) || configCount == 0)
+		{
+			std::cerr << "ERROR::HEADLESS::NO_EGL_CONFIG" << std::endl;
+			return;
+		}
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cerr << "ERROR::HEADLESS::EGL_CREATE_CONTEXT_FAILED" << std::endl;
+		return;
+	}
+	m_Context = context;
+
+	EGLSurface surface = EGL_NO_SURFACE;
+	const char* displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+	if (!displayExtensions || !std::strstr(displayExtensions, "EGL_KHR_surfaceless_context"))
+	{
+		const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+		m_Surface = surface;
+	}
+
+	if (!eglMakeCurrent(display, surface, surface, context))
+	{
+		std::cerr << "ERROR::HEADLESS::EGL_MAKE_CURRENT_FAILED" << std::endl;
+		return;
+	}
+
+	std::cout << "headless EGL " << major << "." << minor << " context created" << std::endl;
+	m_IsValid = true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	for (GLsync fence : m_FrameFences)
+	{
+		if (fence)
+		{
+			glDeleteSync(fence);
+		}
+	}
+
+	if (!m_Display)
+	{
+		return;
+	}
+
+	eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (m_Surface)
+	{
+		eglDestroySurface(m_Display, m_Surface);
+	}
+	if (m_Context)
+	{
+		eglDestroyContext(m_Display, m_Context);
+	}
+	eglTerminate(m_Display);
+}
+
+GLADloadproc HeadlessContext::GetLoadProc() const
+{
+	return [](const char* name)
+	{
+		return reinterpret_cast<void*>(eglGetProcAddress(name));
+	};
+}
+
+#else
+
+HeadlessContext::HeadlessContext(int width, int height)
+{
+	if (!glfwInit())
+	{
+		std::cerr << "glfwInit() failed" << std::endl;
+		return;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	m_Window = glfwCreateWindow(width, height, "LearnOpenGl (headless)", nullptr, nullptr);
+	if (!m_Window)
+	{
+		std::cerr << "ERROR::HEADLESS::HIDDEN_WINDOW_FAILED" << std::endl;
+		glfwTerminate();
+		return;
+	}
+
+	glfwMakeContextCurrent(m_Window);
+	m_IsValid = true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	for (GLsync fence : m_FrameFences)
+	{
+		if (fence)
+		{
+			glDeleteSync(fence);
+		}
+	}
+
+	if (m_Window)
+	{
+		glfwDestroyWindow(m_Window);
+		glfwTerminate();
+	}
+}
+
+GLADloadproc HeadlessContext::GetLoadProc() const
+{
+	return (GLADloadproc)glfwGetProcAddress;
+}
+
+#endif
+
+void HeadlessContext::SwapBuffers()
+{
+	// Wait for the frame that was submitted framesInFlight frames ago, like a blocking swap would
+	GLsync& fence = m_FrameFences[m_FrameIndex];
+	if (fence)
+	{
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(fence);
+	}
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	m_FrameIndex = (m_FrameIndex + 1) % framesInFlight;
+}
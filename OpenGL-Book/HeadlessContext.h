@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// EGL is the only way to get a context on Linux boxes without a display server (e.g. Mesa llvmpipe in CI).
+// Everywhere else, or with HEADLESS_USE_GLFW defined, a hidden GLFW window provides the context instead.
+#if defined(__linux__) && !defined(HEADLESS_USE_GLFW)
+#define HEADLESS_EGL
+#endif
+
+struct GLFWwindow;
+
+// A GL 3.3 core context without a visible window. There is no usable default framebuffer,
+// render into a Framebuffer instead.
+class HeadlessContext
+{
+public:
+	HeadlessContext(int width, int height);
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	bool IsValid() const
+	{
+		return m_IsValid;
+	}
+
+	// Pass to gladLoadGLLoader
+	GLADloadproc GetLoadProc() const;
+
+	// Stands in for a swap chain: keeps at most framesInFlight frames queued so the CPU can't run away from the GPU
+	void SwapBuffers();
+
+private:
+	static constexpr int framesInFlight = 2;
+
+	bool m_IsValid = false;
+	GLsync m_FrameFences[framesInFlight] = {};
+	int m_FrameIndex = 0;
+
+#ifdef HEADLESS_EGL
+	// EGLDisplay / EGLContext / EGLSurface, kept opaque so the EGL headers don't leak into everything
+	void* m_Display = nullptr;
+	void* m_Context = nullptr;
+	void* m_Surface = nullptr;
+#else
+	GLFWwindow* m_Window = nullptr;
+#endif
+};
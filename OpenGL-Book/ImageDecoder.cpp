@@ -0,0 +1,59 @@
+#include <cstring>
+#include <iostream>
+#include "ImageDecoder.h"
+
+namespace
+{
+	const unsigned char pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	ImageFormat DetectFormat(const unsigned char* data, size_t size)
+	{
+		if (size >= sizeof(pngSignature) && std::memcmp(data, pngSignature, sizeof(pngSignature)) == 0)
+		{
+			return ImageFormat::Png;
+		}
+		if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+		{
+			return ImageFormat::Jpeg;
+		}
+		return ImageFormat::Unknown;
+	}
+}
+
+bool ImageDecoder::ReadInfo(const unsigned char* data, size_t size, ImageInfo& info)
+{
+	info = ImageInfo();
+	bool isValid;
+	switch (DetectFormat(data, size))
+	{
+	case ImageFormat::Png:
+		isValid = ReadPngInfo(data, size, info);
+		break;
+	case ImageFormat::Jpeg:
+		isValid = ReadJpegInfo(data, size, info);
+		break;
+	default:
+		std::cerr << "ERROR::IMAGE_DECODER::UNKNOWN_FORMAT" << std::endl;
+		return false;
+	}
+
+	if (isValid && (info.width <= 0 || info.height <= 0 || info.width > maxDimension || info.height > maxDimension))
+	{
+		std::cerr << "ERROR::IMAGE_DECODER::BAD_DIMENSIONS " << info.width << "x" << info.height << std::endl;
+		return false;
+	}
+	return isValid;
+}
+
+bool ImageDecoder::Decode(const unsigned char* data, size_t size, const ImageInfo& info, unsigned char* pixels)
+{
+	switch (info.format)
+	{
+	case ImageFormat::Png:
+		return DecodePng(data, size, info, pixels);
+	case ImageFormat::Jpeg:
+		return DecodeJpeg(data, size, info, pixels);
+	default:
+		return false;
+	}
+}
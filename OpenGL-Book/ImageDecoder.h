@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+enum class ImageFormat
+{
+	Unknown,
+	Png,
+	Jpeg
+};
+
+struct ImageInfo
+{
+	ImageFormat format = ImageFormat::Unknown;
+	int width = 0;
+	int height = 0;
+};
+
+// PNG and baseline JPEG decoding straight from an encoded file in memory, always to tightly packed RGBA8 rows
+// top to bottom. Split in two so the caller can find the output memory once the size is known.
+// Safe to call from any thread, scratch memory is kept per thread and reused by the next image.
+// Not supported: interlaced PNG and progressive / arithmetic coded JPEG, they fail with an error.
+class ImageDecoder
+{
+public:
+	// Only parses the headers
+	static bool ReadInfo(const unsigned char* data, size_t size, ImageInfo& info);
+
+	// pixels must hold GetDecodedSize(info) bytes
+	static bool Decode(const unsigned char* data, size_t size, const ImageInfo& info, unsigned char* pixels);
+
+	static size_t GetDecodedSize(const ImageInfo& info)
+	{
+		return static_cast<size_t>(info.width) * info.height * 4;
+	}
+
+	// Larger images are rejected, it keeps every size computation far away from overflowing
+	static constexpr int maxDimension = 16384;
+
+private:
+	static bool ReadPngInfo(const unsigned char* data, size_t size, ImageInfo& info);
+	static bool DecodePng(const unsigned char* data, size_t size, const ImageInfo& info, unsigned char* pixels);
+	static bool ReadJpegInfo(const unsigned char* data, size_t size, ImageInfo& info);
+	static bool DecodeJpeg(const unsigned char* data, size_t size, const ImageInfo& info, unsigned char* pixels);
+};
@@ -0,0 +1,401 @@
+#include <cstdint>
+#include <cstring>
+#include "Inflate.h"
+
+namespace
+{
+	constexpr int maxCodeLength = 15;
+	// Codes up to this long are decoded with a single table lookup, longer ones walk the canonical code
+	constexpr int fastBits = 9;
+
+	struct Huffman
+	{
+		// (length << 9) | symbol, 0 if the code is longer than fastBits
+		uint16_t fast[1 << fastBits];
+		uint16_t counts[maxCodeLength + 1];
+		uint16_t symbols[288];
+	};
+
+	const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	// Order the code length code lengths are stored in
+	const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	class Inflater
+	{
+	public:
+		Inflater(const unsigned char* input, size_t inputSize, unsigned char* output, size_t outputSize)
+			: m_Input(input), m_InputSize(inputSize), m_Output(output), m_OutputSize(outputSize)
+		{
+		}
+
+		bool Run();
+
+	private:
+		// Deflate packs from the least significant bit, past the end of the input reads zeros and IsOverrun() says so
+		void Refill()
+		{
+			while (m_BitCount <= 56)
+			{
+				uint64_t byte = m_Position < m_InputSize ? m_Input[m_Position] : 0;
+				m_Position++;
+				m_BitBuffer |= byte << m_BitCount;
+				m_BitCount += 8;
+			}
+		}
+
+		uint32_t Bits(int count)
+		{
+			if (m_BitCount < count)
+			{
+				Refill();
+			}
+			uint32_t value = static_cast<uint32_t>(m_BitBuffer & ((uint64_t(1) << count) - 1));
+			m_BitBuffer >>= count;
+			m_BitCount -= count;
+			return value;
+		}
+
+		bool IsOverrun() const
+		{
+			// Bytes still sitting in the bit buffer were counted as read
+			return m_Position - m_BitCount / 8 > m_InputSize;
+		}
+
+		bool Build(Huffman& huffman, const uint8_t* lengths, int count);
+		int Decode(const Huffman& huffman);
+		bool Stored();
+		bool Codes(const Huffman& lengths, const Huffman& distances);
+		bool Dynamic(Huffman& lengths, Huffman& distances);
+		void Fixed(Huffman& lengths, Huffman& distances);
+
+	private:
+		const unsigned char* m_Input;
+		size_t m_InputSize;
+		size_t m_Position = 0;
+		uint64_t m_BitBuffer = 0;
+		int m_BitCount = 0;
+
+		unsigned char* m_Output;
+		size_t m_OutputSize;
+		size_t m_OutputPosition = 0;
+	};
+
+	bool Inflater::Build(Huffman& huffman, const uint8_t* lengths, int count)
+	{
+		std::memset(huffman.counts, 0, sizeof(huffman.counts));
+		std::memset(huffman.fast, 0, sizeof(huffman.fast));
+		for (int i = 0; i < count; i++)
+		{
+			huffman.counts[lengths[i]]++;
+		}
+		huffman.counts[0] = 0;
+
+		// An over-subscribed set of lengths can't be a prefix code, an incomplete one is allowed (single distance code)
+		int left = 1;
+		for (int length = 1; length <= maxCodeLength; length++)
+		{
+			left = (left << 1) - huffman.counts[length];
+			if (left < 0)
+			{
+				return false;
+			}
+		}
+
+		uint16_t offsets[maxCodeLength + 2];
+		uint16_t codes[maxCodeLength + 2];
+		offsets[1] = 0;
+		codes[1] = 0;
+		for (int length = 1; length <= maxCodeLength; length++)
+		{
+			offsets[length + 1] = offsets[length] + huffman.counts[length];
+			codes[length + 1] = static_cast<uint16_t>((codes[length] + huffman.counts[length]) << 1);
+		}
+
+		for (int symbol = 0; symbol < count; symbol++)
+		{
+			int length = lengths[symbol];
+			if (length == 0)
+			{
+				continue;
+			}
+			huffman.symbols[offsets[length]++] = static_cast<uint16_t>(symbol);
+
+			uint32_t code = codes[length]++;
+			if (length > fastBits)
+			{
+				continue;
+			}
+			// Codes are stored most significant bit first, the bit buffer is read the other way around
+			uint32_t reversed = 0;
+			for (int bit = 0; bit < length; bit++)
+			{
+				reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+			}
+			for (uint32_t fill = reversed; fill < (1u << fastBits); fill += 1u << length)
+			{
+				huffman.fast[fill] = static_cast<uint16_t>((length << 9) | symbol);
+			}
+		}
+		return true;
+	}
+
+	int Inflater::Decode(const Huffman& huffman)
+	{
+		if (m_BitCount < maxCodeLength)
+		{
+			Refill();
+		}
+
+		uint16_t entry = huffman.fast[m_BitBuffer & ((1 << fastBits) - 1)];
+		if (entry)
+		{
+			int length = entry >> 9;
+			m_BitBuffer >>= length;
+			m_BitCount -= length;
+			return entry & 0x1FF;
+		}
+
+		// Canonical decode one bit at a time: codes of each length are consecutive, starting at first
+		int code = 0;
+		int first = 0;
+		int index = 0;
+		for (int length = 1; length <= maxCodeLength; length++)
+		{
+			code |= static_cast<int>(m_BitBuffer & 1);
+			m_BitBuffer >>= 1;
+			m_BitCount--;
+			int count = huffman.counts[length];
+			if (code - first < count)
+			{
+				return huffman.symbols[index + code - first];
+			}
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+		return -1;
+	}
+
+	bool Inflater::Stored()
+	{
+		// Stored blocks start on a byte boundary, give back the whole bytes still in the bit buffer
+		Bits(m_BitCount % 8);
+		m_Position -= m_BitCount / 8;
+		m_BitBuffer = 0;
+		m_BitCount = 0;
+
+		if (m_Position + 4 > m_InputSize)
+		{
+			return false;
+		}
+		size_t length = m_Input[m_Position] | (m_Input[m_Position + 1] << 8);
+		size_t inverse = m_Input[m_Position + 2] | (m_Input[m_Position + 3] << 8);
+		m_Position += 4;
+		if (length != (~inverse & 0xFFFF) || m_Position + length > m_InputSize || m_OutputPosition + length > m_OutputSize)
+		{
+			return false;
+		}
+
+		std::memcpy(m_Output + m_OutputPosition, m_Input + m_Position, length);
+		m_Position += length;
+		m_OutputPosition += length;
+		return true;
+	}
+
+	bool Inflater::Codes(const Huffman& lengths, const Huffman& distances)
+	{
+		while (true)
+		{
+			int symbol = Decode(lengths);
+			if (symbol < 0 || IsOverrun())
+			{
+				return false;
+			}
+
+			if (symbol < 256)
+			{
+				if (m_OutputPosition == m_OutputSize)
+				{
+					return false;
+				}
+				m_Output[m_OutputPosition++] = static_cast<unsigned char>(symbol);
+				continue;
+			}
+			if (symbol == 256)
+			{
+				return true;
+			}
+
+			symbol -= 257;
+			if (symbol >= 29)
+			{
+				return false;
+			}
+			size_t length = lengthBase[symbol] + Bits(lengthExtra[symbol]);
+
+			int distanceSymbol = Decode(distances);
+			if (distanceSymbol < 0 || distanceSymbol >= 30)
+			{
+				return false;
+			}
+			size_t distance = distanceBase[distanceSymbol] + Bits(distanceExtra[distanceSymbol]);
+			if (distance > m_OutputPosition || m_OutputPosition + length > m_OutputSize)
+			{
+				return false;
+			}
+
+			// Byte by byte on purpose, the source may overlap what is being written (runs)
+			unsigned char* to = m_Output + m_OutputPosition;
+			const unsigned char* from = to - distance;
+			for (size_t i = 0; i < length; i++)
+			{
+				to[i] = from[i];
+			}
+			m_OutputPosition += length;
+		}
+	}
+
+	void Inflater::Fixed(Huffman& lengths, Huffman& distances)
+	{
+		uint8_t codeLengths[288];
+		std::memset(codeLengths, 8, 144);
+		std::memset(codeLengths + 144, 9, 112);
+		std::memset(codeLengths + 256, 7, 24);
+		std::memset(codeLengths + 280, 8, 8);
+		Build(lengths, codeLengths, 288);
+
+		std::memset(codeLengths, 5, 30);
+		Build(distances, codeLengths, 30);
+	}
+
+	bool Inflater::Dynamic(Huffman& lengths, Huffman& distances)
+	{
+		int lengthCount = Bits(5) + 257;
+		int distanceCount = Bits(5) + 1;
+		int codeLengthCount = Bits(4) + 4;
+		if (lengthCount > 286 || distanceCount > 30)
+		{
+			return false;
+		}
+
+		uint8_t codeLengths[288 + 32] = {};
+		for (int i = 0; i < codeLengthCount; i++)
+		{
+			codeLengths[codeLengthOrder[i]] = static_cast<uint8_t>(Bits(3));
+		}
+		Huffman codeLengthCode;
+		if (!Build(codeLengthCode, codeLengths, 19))
+		{
+			return false;
+		}
+
+		// Literal/length and distance code lengths are one run length coded sequence
+		std::memset(codeLengths, 0, sizeof(codeLengths));
+		int index = 0;
+		while (index < lengthCount + distanceCount)
+		{
+			int symbol = Decode(codeLengthCode);
+			if (symbol < 0 || IsOverrun())
+			{
+				return false;
+			}
+			if (symbol < 16)
+			{
+				codeLengths[index++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+
+			uint8_t repeated = 0;
+			int repeat;
+			if (symbol == 16)
+			{
+				if (index == 0)
+				{
+					return false;
+				}
+				repeated = codeLengths[index - 1];
+				repeat = 3 + Bits(2);
+			}
+			else if (symbol == 17)
+			{
+				repeat = 3 + Bits(3);
+			}
+			else
+			{
+				repeat = 11 + Bits(7);
+			}
+			if (index + repeat > lengthCount + distanceCount)
+			{
+				return false;
+			}
+			while (repeat--)
+			{
+				codeLengths[index++] = repeated;
+			}
+		}
+
+		if (codeLengths[256] == 0)
+		{
+			return false;
+		}
+		return Build(lengths, codeLengths, lengthCount) && Build(distances, codeLengths + lengthCount, distanceCount);
+	}
+
+	bool Inflater::Run()
+	{
+		// zlib header: deflate with a window of at most 32K, no preset dictionary, checksum over the first two bytes
+		if (m_InputSize < 2)
+		{
+			return false;
+		}
+		unsigned int method = m_Input[0];
+		unsigned int flags = m_Input[1];
+		if ((method & 0x0F) != 8 || (method >> 4) > 7 || (flags & 0x20) || ((method << 8) | flags) % 31 != 0)
+		{
+			return false;
+		}
+		m_Position = 2;
+
+		Huffman lengths;
+		Huffman distances;
+		bool isLast = false;
+		while (!isLast)
+		{
+			isLast = Bits(1) != 0;
+			unsigned int type = Bits(2);
+			bool isValid;
+			switch (type)
+			{
+			case 0:
+				isValid = Stored();
+				break;
+			case 1:
+				Fixed(lengths, distances);
+				isValid = Codes(lengths, distances);
+				break;
+			case 2:
+				isValid = Dynamic(lengths, distances) && Codes(lengths, distances);
+				break;
+			default:
+				isValid = false;
+				break;
+			}
+			if (!isValid || IsOverrun())
+			{
+				return false;
+			}
+		}
+
+		// The Adler-32 trailer is not checked, PNG chunks already carry a CRC
+		return m_OutputPosition == m_OutputSize;
+	}
+}
+
+bool Inflate(const unsigned char* input, size_t inputSize, unsigned char* output, size_t outputSize)
+{
+	Inflater inflater(input, inputSize, output, outputSize);
+	return inflater.Run();
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// Decompresses a zlib stream (RFC 1950/1951) into a buffer of known size, which is all PNG needs.
+// Returns false on corrupt input or if the data doesn't fill output exactly.
+bool Inflate(const unsigned char* input, size_t inputSize, unsigned char* output, size_t outputSize);
@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <algorithm>
+#include "GLState.h"
+#include "InstanceBuffer.h"
+
+InstanceBuffer::InstanceBuffer(unsigned int vao, unsigned int drawCount, unsigned int maxInstances, GLenum indexType)
+	: m_VAO(vao), m_DrawCount(drawCount), m_MaxInstances(maxInstances), m_IndexType(indexType)
+{
+	glGenBuffers(1, &m_InstanceVBO);
+
+	GLState::BindVertexArray(m_VAO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, m_MaxInstances * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+
+	// offset, scale and rotation packed into one vec4
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, offsetX));
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1); // Advance once per instance instead of once per vertex
+
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, r));
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+	GLState::OnBufferDeleted(m_InstanceVBO);
+	glDeleteBuffers(1, &m_InstanceVBO);
+}
+
+void InstanceBuffer::Upload(const InstanceData* instances, unsigned int count)
+{
+	m_InstanceCount = std::min(count, m_MaxInstances);
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+	// Orphan first so the upload doesn't wait for the previous frame's draw to finish reading
+	glBufferData(GL_ARRAY_BUFFER, m_MaxInstances * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_InstanceCount * sizeof(InstanceData), instances);
+}
+
+void InstanceBuffer::Draw() const
+{
+	if (m_InstanceCount == 0)
+	{
+		return;
+	}
+
+	GLState::BindVertexArray(m_VAO);
+	if (m_IndexType)
+	{
+		glDrawElementsInstanced(GL_TRIANGLES, m_DrawCount, m_IndexType, nullptr, m_InstanceCount);
+	}
+	else
+	{
+		glDrawArraysInstanced(GL_TRIANGLES, 0, m_DrawCount, m_InstanceCount);
+	}
+}
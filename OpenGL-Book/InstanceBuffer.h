@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+
+// Per instance data for instanced.vert, attribute locations 2 and 3
+struct InstanceData
+{
+	float offsetX, offsetY;
+	float scale;
+	float rotation;		// radians
+	float r, g, b;
+};
+
+// Adds per instance attributes (glVertexAttribDivisor 1) to an existing VAO and draws it instanced.
+// Instance data is uploaded once per frame with a single orphan + glBufferSubData.
+class InstanceBuffer
+{
+public:
+	// Bit mask of the locations fed from the instance buffer, see ShaderReflection::CheckVertexFormat()
+	static constexpr uint32_t attributeLocations = (1u << 2) | (1u << 3);
+
+	// The VAO keeps its per vertex attributes at locations 0 and 1. indexType is 0 for glDrawArraysInstanced,
+	// otherwise the VAO needs an element buffer and drawCount is the number of indices.
+	InstanceBuffer(unsigned int vao, unsigned int drawCount, unsigned int maxInstances, GLenum indexType = 0);
+	~InstanceBuffer();
+
+	InstanceBuffer(const InstanceBuffer&) = delete;
+	InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+	// Anything past maxInstances is dropped
+	void Upload(const InstanceData* instances, unsigned int count);
+
+	void Draw() const;
+
+	unsigned int GetInstanceCount() const
+	{
+		return m_InstanceCount;
+	}
+
+private:
+	unsigned int m_VAO;
+	unsigned int m_InstanceVBO = 0;
+	unsigned int m_DrawCount;
+	unsigned int m_MaxInstances;
+	unsigned int m_InstanceCount = 0;
+	GLenum m_IndexType;
+};
@@ -0,0 +1,149 @@
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include "JobSystem.h"
+#include "JobBenchmark.h"
+
+namespace
+{
+	constexpr size_t objectCount = 256 * 1024;
+	constexpr size_t batchSize = 4096;
+	constexpr int warmupFrames = 3;
+	constexpr int measuredFrames = 30;
+
+	struct SceneObject
+	{
+		float baseX, baseY, baseZ;
+		float phase;
+		float x, y, z;
+		float radius;
+	};
+
+	struct Plane
+	{
+		float nx, ny, nz, d;
+	};
+
+	std::vector<SceneObject> MakeScene()
+	{
+		std::vector<SceneObject> objects(objectCount);
+		uint32_t seed = 12345;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return static_cast<float>(seed >> 8) / static_cast<float>(1 << 24);
+		};
+		for (SceneObject& object : objects)
+		{
+			object.baseX = random() * 200.0f - 100.0f;
+			object.baseY = random() * 200.0f - 100.0f;
+			object.baseZ = random() * 200.0f - 100.0f;
+			object.phase = random() * 6.2831853f;
+			object.radius = 0.5f + random();
+		}
+		return objects;
+	}
+
+	// One frame: animation, culling that depends on it, and draw list building that depends on the culling
+	void RunFrame(JobSystem& jobs, std::vector<SceneObject>& objects, std::vector<uint8_t>& isVisible,
+		std::vector<std::vector<uint32_t>>& drawLists, float time)
+	{
+		// A box frustum, -50..50 on every axis
+		static const Plane planes[6] = {
+			{ 1.0f, 0.0f, 0.0f, 50.0f }, { -1.0f, 0.0f, 0.0f, 50.0f },
+			{ 0.0f, 1.0f, 0.0f, 50.0f }, { 0.0f, -1.0f, 0.0f, 50.0f },
+			{ 0.0f, 0.0f, 1.0f, 50.0f }, { 0.0f, 0.0f, -1.0f, 50.0f }
+		};
+
+		JobCounter animated;
+		jobs.ParallelFor(objects.size(), batchSize, [&objects, time](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				SceneObject& object = objects[i];
+				float angle = time + object.phase;
+				object.x = object.baseX + std::sin(angle) * 10.0f;
+				object.y = object.baseY + std::cos(angle * 1.3f) * 10.0f;
+				object.z = object.baseZ + std::sin(angle * 0.7f) * 10.0f;
+			}
+		}, animated);
+
+		JobCounter culled;
+		jobs.ParallelFor(objects.size(), batchSize, [&objects, &isVisible](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const SceneObject& object = objects[i];
+				bool isInside = true;
+				for (const Plane& plane : planes)
+				{
+					isInside &= plane.nx * object.x + plane.ny * object.y + plane.nz * object.z + plane.d > -object.radius;
+				}
+				isVisible[i] = isInside;
+			}
+		}, culled, &animated);
+
+		JobCounter built;
+		jobs.ParallelFor(objects.size(), batchSize, [&isVisible, &drawLists](size_t begin, size_t end)
+		{
+			std::vector<uint32_t>& drawList = drawLists[begin / batchSize];
+			drawList.clear();
+			for (size_t i = begin; i < end; i++)
+			{
+				if (isVisible[i])
+				{
+					drawList.push_back(static_cast<uint32_t>(i));
+				}
+			}
+		}, built, &culled);
+
+		jobs.Wait(built);
+	}
+}
+
+int RunJobBenchmark(unsigned int maxWorkers)
+{
+	if (maxWorkers == 0)
+	{
+		maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::vector<SceneObject> objects = MakeScene();
+	std::vector<uint8_t> isVisible(objects.size());
+	std::vector<std::vector<uint32_t>> drawLists((objects.size() + batchSize - 1) / batchSize);
+
+	std::cout << objectCount << " objects, " << drawLists.size() << " batches per pass" << std::endl;
+	std::cout << "workers\tframe ms\tspeedup\tvisible" << std::endl;
+
+	double singleWorkerTime = 0.0;
+	for (unsigned int workerCount = 1; workerCount <= maxWorkers; workerCount++)
+	{
+		JobSystem jobs(workerCount);
+		for (int frame = 0; frame < warmupFrames; frame++)
+		{
+			RunFrame(jobs, objects, isVisible, drawLists, frame * 0.016f);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < measuredFrames; frame++)
+		{
+			RunFrame(jobs, objects, isVisible, drawLists, frame * 0.016f);
+		}
+		double frameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / measuredFrames;
+		if (workerCount == 1)
+		{
+			singleWorkerTime = frameTime;
+		}
+
+		size_t visibleCount = 0;
+		for (const std::vector<uint32_t>& drawList : drawLists)
+		{
+			visibleCount += drawList.size();
+		}
+		std::cout << workerCount << "\t" << frameTime << "\t" << singleWorkerTime / frameTime << "x\t" << visibleCount << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Runs a frame shaped workload (animate, then frustum cull, then build draw lists) on the job system
+// with 1 to maxWorkers workers and prints the frame time and speedup of each. 0 goes up to the hardware thread count.
+int RunJobBenchmark(unsigned int maxWorkers = 0);
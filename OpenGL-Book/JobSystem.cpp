@@ -0,0 +1,198 @@
+#include <algorithm>
+#include "Profiler.h"
+#include "JobSystem.h"
+
+namespace
+{
+	// Which system's worker thread this is, threads that aren't workers push to and run from worker 0
+	thread_local const JobSystem* t_System = nullptr;
+	thread_local unsigned int t_WorkerIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	if (workerCount == 0)
+	{
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		m_Workers.push_back(std::make_unique<Worker>());
+	}
+	// All deques have to exist before the first worker starts stealing
+	for (unsigned int i = 1; i < workerCount; i++)
+	{
+		m_Workers[i]->thread = std::thread(&JobSystem::ThreadMain, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_IsRunning = false;
+	}
+	m_SleepCondition.notify_all();
+
+	for (std::unique_ptr<Worker>& worker : m_Workers)
+	{
+		if (worker->thread.joinable())
+		{
+			worker->thread.join();
+		}
+	}
+}
+
+unsigned int JobSystem::GetCurrentWorker() const
+{
+	return t_System == this ? t_WorkerIndex : 0;
+}
+
+void JobSystem::Run(std::function<void()> job, JobCounter* counter, JobCounter* dependency)
+{
+	if (counter)
+	{
+		counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (dependency)
+	{
+		// Checked under the dependency's lock so Finish() can't drain the list between the check and the push
+		std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+		if (dependency->m_Count.load(std::memory_order_acquire) > 0)
+		{
+			dependency->m_Dependents.emplace_back(std::move(job), counter);
+			return;
+		}
+	}
+
+	Push({ std::move(job), counter });
+}
+
+void JobSystem::Push(Job job)
+{
+	Worker& worker = *m_Workers[GetCurrentWorker()];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.push_back(std::move(job));
+	}
+
+	// Taking the sleep mutex once orders the increment before a sleeping worker's check, so the wakeup can't get lost
+	m_QueuedJobs.fetch_add(1, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_SleepCondition.notify_one();
+}
+
+bool JobSystem::TryRunJob(unsigned int workerIndex)
+{
+	Job job;
+	bool isFound = false;
+
+	// Newest job of our own first, it is the most likely to still be in cache
+	{
+		Worker& worker = *m_Workers[workerIndex];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.jobs.empty())
+		{
+			job = std::move(worker.jobs.back());
+			worker.jobs.pop_back();
+			isFound = true;
+		}
+	}
+
+	// Otherwise steal the oldest job of another worker, that's usually the biggest chunk of work left
+	for (size_t i = 1; !isFound && i < m_Workers.size(); i++)
+	{
+		Worker& victim = *m_Workers[(workerIndex + i) % m_Workers.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			isFound = true;
+		}
+	}
+
+	if (!isFound)
+	{
+		return false;
+	}
+
+	m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	job.function();
+	Finish(job.counter);
+	return true;
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+	if (!counter)
+	{
+		return;
+	}
+
+	// Not the last job of the group, nothing can be released yet
+	int count = counter->m_Count.load(std::memory_order_acquire);
+	while (count > 1)
+	{
+		if (counter->m_Count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel))
+		{
+			return;
+		}
+	}
+
+	// Possibly the last one. Reaching zero under the lock means Run() either sees the old count and appends
+	// to the list taken here, or sees zero and pushes the job itself. Dependents' counters were incremented in Run().
+	std::vector<std::pair<std::function<void()>, JobCounter*>> dependents;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		if (counter->m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			dependents.swap(counter->m_Dependents);
+		}
+	}
+	for (auto& [function, dependentCounter] : dependents)
+	{
+		Push({ std::move(function), dependentCounter });
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	unsigned int workerIndex = GetCurrentWorker();
+	while (!counter.IsDone())
+	{
+		if (!TryRunJob(workerIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ThreadMain(unsigned int workerIndex)
+{
+	Profiler::SetThreadName("Job Worker");
+	t_System = this;
+	t_WorkerIndex = workerIndex;
+
+	while (true)
+	{
+		if (TryRunJob(workerIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_SleepCondition.wait(lock, [this]()
+		{
+			return !m_IsRunning || m_QueuedJobs.load(std::memory_order_acquire) > 0;
+		});
+		if (!m_IsRunning)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+
+// Counts the unfinished jobs of a group. Wait on it with JobSystem::Wait(), or pass it as the dependency of later jobs.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+
+	// The last job may still be unlocking m_Mutex right after the count reached zero
+	~JobCounter()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+	}
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const
+	{
+		return m_Count.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	friend class JobSystem;
+
+	std::atomic<int> m_Count = 0;
+	// Jobs that depend on this counter, queued once it reaches zero
+	std::mutex m_Mutex;
+	std::vector<std::pair<std::function<void()>, JobCounter*>> m_Dependents;
+};
+
+// Work stealing scheduler: every worker has its own deque, pushes and pops at the back and steals from the front
+// of the others when it runs dry. The thread that created the system is worker 0 and only runs jobs inside Wait().
+// No fibers, a job that waits on other jobs keeps running them until its counter is done.
+class JobSystem
+{
+public:
+	// workerCount 0 uses one worker per hardware thread, the calling thread counts as one of them
+	explicit JobSystem(unsigned int workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// counter is incremented now and decremented when the job finished. With a dependency the job is only queued
+	// once the dependency's jobs are all done.
+	void Run(std::function<void()> job, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	// Splits [0, count) into batches of batchSize items, function(begin, end) runs once per batch
+	template<typename Function>
+	void ParallelFor(size_t count, size_t batchSize, Function function, JobCounter& counter, JobCounter* dependency = nullptr)
+	{
+		for (size_t begin = 0; begin < count; begin += batchSize)
+		{
+			size_t end = begin + batchSize < count ? begin + batchSize : count;
+			Run([function, begin, end]() { function(begin, end); }, &counter, dependency);
+		}
+	}
+
+	// Runs jobs on the calling thread until the counter is done
+	void Wait(JobCounter& counter);
+
+	unsigned int GetWorkerCount() const
+	{
+		return static_cast<unsigned int>(m_Workers.size());
+	}
+
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter;
+	};
+
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+		std::thread thread;
+	};
+
+	void Push(Job job);
+	bool TryRunJob(unsigned int workerIndex);
+	void Finish(JobCounter* counter);
+	void ThreadMain(unsigned int workerIndex);
+
+	unsigned int GetCurrentWorker() const;
+
+private:
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+
+	// Idle workers sleep here, m_QueuedJobs keeps them from missing a push
+	std::mutex m_SleepMutex;
+	std::condition_variable m_SleepCondition;
+	std::atomic<int> m_QueuedJobs = 0;
+	bool m_IsRunning = true;
+};
@@ -0,0 +1,782 @@
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "ImageDecoder.h"
+
+namespace
+{
+	// Natural (row major) index of the nth coefficient in zig-zag order
+	const uint8_t zigZag[64] = {
+		0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+	};
+
+	constexpr int fastBits = 9;
+	constexpr int maxComponents = 3;
+
+	struct HuffmanTable
+	{
+		// (length << 8) | value for codes up to fastBits long, 0 otherwise
+		uint16_t fast[1 << fastBits];
+		// Canonical decoding of the longer codes: the largest code of each length and where its values start
+		int32_t maxCode[18];
+		int32_t valueOffset[17];
+		uint8_t values[256];
+		bool isDefined;
+	};
+
+	struct Component
+	{
+		int id;
+		int h;
+		int v;
+		int quantTable;
+		int dcTable;
+		int acTable;
+		int dcPrediction;
+		// The plane covers whole MCUs, so it is usually a bit larger than the image
+		int planeWidth;
+		int planeHeight;
+		size_t planeOffset;
+	};
+
+	// Component planes of the image being decoded
+	thread_local std::vector<unsigned char> t_Planes;
+
+	struct IdctTable
+	{
+		// c(u) * cos((2x + 1) * u * pi / 16) / 2
+		float factors[8][8];
+
+		IdctTable()
+		{
+			for (int x = 0; x < 8; x++)
+			{
+				for (int u = 0; u < 8; u++)
+				{
+					float scale = u == 0 ? 1.0f / std::sqrt(2.0f) : 1.0f;
+					factors[x][u] = scale * std::cos((2 * x + 1) * u * 3.14159265358979f / 16.0f) * 0.5f;
+				}
+			}
+		}
+	};
+
+	const IdctTable idctTable;
+
+	// Separable float IDCT, rows then columns, writes the level shifted and clamped samples
+	void InverseDct(const float* coefficients, unsigned char* out, int stride)
+	{
+		float rows[64];
+		for (int y = 0; y < 8; y++)
+		{
+			const float* in = coefficients + y * 8;
+			for (int x = 0; x < 8; x++)
+			{
+				const float* factors = idctTable.factors[x];
+				float sum = 0.0f;
+				for (int u = 0; u < 8; u++)
+				{
+					sum += factors[u] * in[u];
+				}
+				rows[y * 8 + x] = sum;
+			}
+		}
+
+		for (int x = 0; x < 8; x++)
+		{
+			for (int y = 0; y < 8; y++)
+			{
+				const float* factors = idctTable.factors[y];
+				float sum = 0.0f;
+				for (int v = 0; v < 8; v++)
+				{
+					sum += factors[v] * rows[v * 8 + x];
+				}
+				int value = static_cast<int>(std::lround(sum + 128.0f));
+				out[y * stride + x] = static_cast<unsigned char>(value < 0 ? 0 : value > 255 ? 255 : value);
+			}
+		}
+	}
+
+	class JpegParser
+	{
+	public:
+		JpegParser(const unsigned char* data, size_t size)
+			: m_Data(data), m_Size(size)
+		{
+		}
+
+		// Parses everything up to the frame header
+		bool ReadFrame();
+		bool Decode(unsigned char* pixels);
+
+		int GetWidth() const
+		{
+			return m_Width;
+		}
+
+		int GetHeight() const
+		{
+			return m_Height;
+		}
+
+	private:
+		uint16_t ReadWord(size_t position) const
+		{
+			return static_cast<uint16_t>((m_Data[position] << 8) | m_Data[position + 1]);
+		}
+
+		// Moves to the next marker and returns it with the segment's payload range, 0 at the end of the data
+		int NextSegment(size_t& payload, size_t& payloadSize);
+		bool ReadQuantTables(size_t payload, size_t size);
+		bool ReadHuffmanTables(size_t payload, size_t size);
+		bool ReadFrameHeader(size_t payload, size_t size);
+		bool ReadScanHeader(size_t payload, size_t size);
+
+		void ResetBits();
+		void FillBits();
+		int ReceiveExtend(int length);
+		int DecodeHuffman(const HuffmanTable& table);
+		bool DecodeBlock(Component& component, float* coefficients);
+		bool DecodeScan();
+		bool HandleRestart();
+		void ConvertColors(unsigned char* pixels) const;
+
+	private:
+		const unsigned char* m_Data;
+		size_t m_Size;
+		size_t m_Position = 2;
+
+		int m_Width = 0;
+		int m_Height = 0;
+		int m_MaxH = 1;
+		int m_MaxV = 1;
+		int m_ComponentCount = 0;
+		Component m_Components[maxComponents] = {};
+		// Components of the current scan, in scan order
+		int m_ScanComponents[maxComponents] = {};
+		int m_ScanComponentCount = 0;
+
+		uint16_t m_QuantTables[4][64] = {};
+		HuffmanTable m_DcTables[4] = {};
+		HuffmanTable m_AcTables[4] = {};
+		int m_RestartInterval = 0;
+		bool m_IsAdobeRgb = false;
+
+		// Entropy coded data is read most significant bit first, with 0xFF bytes followed by a stuffed 0x00
+		uint32_t m_BitBuffer = 0;
+		int m_BitCount = 0;
+		bool m_HitMarker = false;
+	};
+
+	int JpegParser::NextSegment(size_t& payload, size_t& payloadSize)
+	{
+		// Fill bytes (0xFF 0xFF ...) are allowed in front of any marker, 0xFF 0x00 is a stuffed byte of leftover scan data
+		while (m_Position + 1 < m_Size && (m_Data[m_Position] != 0xFF || m_Data[m_Position + 1] == 0xFF || m_Data[m_Position + 1] == 0x00))
+		{
+			m_Position++;
+		}
+		if (m_Position + 1 >= m_Size)
+		{
+			return 0;
+		}
+		int marker = m_Data[m_Position + 1];
+		m_Position += 2;
+
+		// Standalone markers have no length
+		if (marker == 0xD8 || marker == 0xD9 || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01)
+		{
+			payload = m_Position;
+			payloadSize = 0;
+			return marker;
+		}
+		if (m_Position + 2 > m_Size)
+		{
+			return 0;
+		}
+		size_t length = ReadWord(m_Position);
+		if (length < 2 || m_Position + length > m_Size)
+		{
+			return 0;
+		}
+		payload = m_Position + 2;
+		payloadSize = length - 2;
+		m_Position += length;
+		return marker;
+	}
+
+	bool JpegParser::ReadQuantTables(size_t payload, size_t size)
+	{
+		size_t end = payload + size;
+		while (payload < end)
+		{
+			int precision = m_Data[payload] >> 4;
+			int id = m_Data[payload] & 0x0F;
+			size_t tableSize = precision ? 128 : 64;
+			if (id > 3 || payload + 1 + tableSize > end)
+			{
+				return false;
+			}
+			payload++;
+			for (int i = 0; i < 64; i++)
+			{
+				m_QuantTables[id][i] = precision ? ReadWord(payload + i * 2) : m_Data[payload + i];
+			}
+			payload += tableSize;
+		}
+		return true;
+	}
+
+	bool JpegParser::ReadHuffmanTables(size_t payload, size_t size)
+	{
+		size_t end = payload + size;
+		while (payload + 17 <= end)
+		{
+			int tableClass = m_Data[payload] >> 4;
+			int id = m_Data[payload] & 0x0F;
+			if (tableClass > 1 || id > 3)
+			{
+				return false;
+			}
+			HuffmanTable& table = tableClass ? m_AcTables[id] : m_DcTables[id];
+			const unsigned char* counts = m_Data + payload + 1;
+			int valueCount = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				valueCount += counts[i];
+			}
+			payload += 17;
+			if (valueCount > 256 || payload + valueCount > end)
+			{
+				return false;
+			}
+			std::memcpy(table.values, m_Data + payload, valueCount);
+			payload += valueCount;
+
+			// Canonical codes: consecutive within a length, doubled when moving to the next length
+			std::memset(table.fast, 0, sizeof(table.fast));
+			int code = 0;
+			int index = 0;
+			for (int length = 1; length <= 16; length++)
+			{
+				int count = counts[length - 1];
+				// Over-subscribed, more codes than this length has room for would fill past the fast table
+				if (code + count > (1 << length))
+				{
+					return false;
+				}
+				table.valueOffset[length] = index - code;
+				for (int i = 0; i < count; i++, code++, index++)
+				{
+					if (length <= fastBits)
+					{
+						int shift = fastBits - length;
+						for (int fill = 0; fill < (1 << shift); fill++)
+						{
+							table.fast[(code << shift) | fill] = static_cast<uint16_t>((length << 8) | table.values[index]);
+						}
+					}
+				}
+				// -1 so a length without codes never matches
+				table.maxCode[length] = count ? code - 1 : -1;
+				code <<= 1;
+			}
+			table.maxCode[17] = 0x7FFFFFFF;
+			table.isDefined = true;
+		}
+		return payload == end;
+	}
+
+	bool JpegParser::ReadFrameHeader(size_t payload, size_t size)
+	{
+		if (size < 6 || m_Data[payload] != 8)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::JPEG_UNSUPPORTED_PRECISION" << std::endl;
+			return false;
+		}
+		m_Height = ReadWord(payload + 1);
+		m_Width = ReadWord(payload + 3);
+		m_ComponentCount = m_Data[payload + 5];
+		if ((m_ComponentCount != 1 && m_ComponentCount != 3) || size < 6 + size_t(m_ComponentCount) * 3 || m_Height == 0)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::JPEG_UNSUPPORTED_COMPONENTS " << m_ComponentCount << std::endl;
+			return false;
+		}
+
+		for (int i = 0; i < m_ComponentCount; i++)
+		{
+			Component& component = m_Components[i];
+			const unsigned char* fields = m_Data + payload + 6 + i * 3;
+			component.id = fields[0];
+			component.h = fields[1] >> 4;
+			component.v = fields[1] & 0x0F;
+			component.quantTable = fields[2];
+			if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quantTable > 3)
+			{
+				return false;
+			}
+			m_MaxH = component.h > m_MaxH ? component.h : m_MaxH;
+			m_MaxV = component.v > m_MaxV ? component.v : m_MaxV;
+		}
+		return true;
+	}
+
+	bool JpegParser::ReadScanHeader(size_t payload, size_t size)
+	{
+		if (size < 1)
+		{
+			return false;
+		}
+		m_ScanComponentCount = m_Data[payload];
+		if (m_ScanComponentCount < 1 || m_ScanComponentCount > m_ComponentCount || size < 4 + size_t(m_ScanComponentCount) * 2)
+		{
+			return false;
+		}
+
+		for (int i = 0; i < m_ScanComponentCount; i++)
+		{
+			int id = m_Data[payload + 1 + i * 2];
+			int tables = m_Data[payload + 2 + i * 2];
+			int index = 0;
+			while (index < m_ComponentCount && m_Components[index].id != id)
+			{
+				index++;
+			}
+			if (index == m_ComponentCount || (tables >> 4) > 3 || (tables & 0x0F) > 3)
+			{
+				return false;
+			}
+			m_Components[index].dcTable = tables >> 4;
+			m_Components[index].acTable = tables & 0x0F;
+			m_ScanComponents[i] = index;
+		}
+		// Spectral selection and successive approximation are fixed in a baseline scan
+		return true;
+	}
+
+	void JpegParser::ResetBits()
+	{
+		m_BitBuffer = 0;
+		m_BitCount = 0;
+		m_HitMarker = false;
+		for (int i = 0; i < m_ComponentCount; i++)
+		{
+			m_Components[i].dcPrediction = 0;
+		}
+	}
+
+	void JpegParser::FillBits()
+	{
+		while (m_BitCount <= 24)
+		{
+			uint32_t byte = 0;
+			// At a marker (or the end) the scan is over, feed zeros and leave the marker for NextSegment()
+			if (!m_HitMarker && m_Position < m_Size)
+			{
+				byte = m_Data[m_Position];
+				if (byte == 0xFF)
+				{
+					int next = m_Position + 1 < m_Size ? m_Data[m_Position + 1] : 0xD9;
+					if (next == 0x00)
+					{
+						m_Position += 2;
+					}
+					else
+					{
+						m_HitMarker = true;
+						byte = 0;
+					}
+				}
+				else
+				{
+					m_Position++;
+				}
+			}
+			m_BitBuffer |= byte << (24 - m_BitCount);
+			m_BitCount += 8;
+		}
+	}
+
+	int JpegParser::ReceiveExtend(int length)
+	{
+		if (length == 0)
+		{
+			return 0;
+		}
+		if (m_BitCount < length)
+		{
+			FillBits();
+		}
+		int value = static_cast<int>(m_BitBuffer >> (32 - length));
+		m_BitBuffer <<= length;
+		m_BitCount -= length;
+		// Values with a leading 0 bit are negative
+		return value < (1 << (length - 1)) ? value - (1 << length) + 1 : value;
+	}
+
+	int JpegParser::DecodeHuffman(const HuffmanTable& table)
+	{
+		if (m_BitCount < 16)
+		{
+			FillBits();
+		}
+
+		uint16_t entry = table.fast[m_BitBuffer >> (32 - fastBits)];
+		if (entry)
+		{
+			int length = entry >> 8;
+			m_BitBuffer <<= length;
+			m_BitCount -= length;
+			return entry & 0xFF;
+		}
+
+		for (int length = fastBits + 1; length <= 16; length++)
+		{
+			int code = static_cast<int>(m_BitBuffer >> (32 - length));
+			if (code <= table.maxCode[length])
+			{
+				m_BitBuffer <<= length;
+				m_BitCount -= length;
+				return table.values[table.valueOffset[length] + code];
+			}
+		}
+		return -1;
+	}
+
+	bool JpegParser::DecodeBlock(Component& component, float* coefficients)
+	{
+		const HuffmanTable& dcTable = m_DcTables[component.dcTable];
+		const HuffmanTable& acTable = m_AcTables[component.acTable];
+		const uint16_t* quant = m_QuantTables[component.quantTable];
+		std::memset(coefficients, 0, 64 * sizeof(float));
+
+		int dcLength = DecodeHuffman(dcTable);
+		if (dcLength < 0 || dcLength > 11)
+		{
+			return false;
+		}
+		component.dcPrediction += ReceiveExtend(dcLength);
+		coefficients[0] = static_cast<float>(component.dcPrediction * quant[0]);
+
+		for (int k = 1; k < 64;)
+		{
+			int symbol = DecodeHuffman(acTable);
+			if (symbol < 0)
+			{
+				return false;
+			}
+			int run = symbol >> 4;
+			int length = symbol & 0x0F;
+			if (length == 0)
+			{
+				// 0xF0 skips 16 zeros, anything else with a zero length ends the block
+				if (run != 15)
+				{
+					break;
+				}
+				k += 16;
+				continue;
+			}
+			k += run;
+			if (k > 63)
+			{
+				return false;
+			}
+			coefficients[zigZag[k]] = static_cast<float>(ReceiveExtend(length) * quant[k]);
+			k++;
+		}
+		return true;
+	}
+
+	bool JpegParser::HandleRestart()
+	{
+		// Whatever bits are left belong to the previous interval, the RSTn marker follows
+		size_t payload;
+		size_t payloadSize;
+		int marker = NextSegment(payload, payloadSize);
+		if (marker < 0xD0 || marker > 0xD7)
+		{
+			return false;
+		}
+		ResetBits();
+		return true;
+	}
+
+	bool JpegParser::DecodeScan()
+	{
+		ResetBits();
+		float coefficients[64];
+
+		// A single component scan isn't interleaved, its blocks simply go row by row over the component's own size
+		if (m_ScanComponentCount == 1)
+		{
+			Component& component = m_Components[m_ScanComponents[0]];
+			int blocksX = (m_Width * component.h / m_MaxH + 7) / 8;
+			int blocksY = (m_Height * component.v / m_MaxV + 7) / 8;
+			// Rounding up per component can differ by a block, the plane is big enough either way
+			blocksX = blocksX < component.planeWidth / 8 ? blocksX : component.planeWidth / 8;
+			blocksY = blocksY < component.planeHeight / 8 ? blocksY : component.planeHeight / 8;
+			int count = 0;
+			for (int by = 0; by < blocksY; by++)
+			{
+				for (int bx = 0; bx < blocksX; bx++)
+				{
+					if (m_RestartInterval && count > 0 && count % m_RestartInterval == 0 && !HandleRestart())
+					{
+						return false;
+					}
+					count++;
+					if (!DecodeBlock(component, coefficients))
+					{
+						return false;
+					}
+					unsigned char* out = t_Planes.data() + component.planeOffset + (size_t(by) * 8 * component.planeWidth) + bx * 8;
+					InverseDct(coefficients, out, component.planeWidth);
+				}
+			}
+			return true;
+		}
+
+		int mcusX = (m_Width + 8 * m_MaxH - 1) / (8 * m_MaxH);
+		int mcusY = (m_Height + 8 * m_MaxV - 1) / (8 * m_MaxV);
+		int count = 0;
+		for (int my = 0; my < mcusY; my++)
+		{
+			for (int mx = 0; mx < mcusX; mx++)
+			{
+				if (m_RestartInterval && count > 0 && count % m_RestartInterval == 0 && !HandleRestart())
+				{
+					return false;
+				}
+				count++;
+
+				// Every component contributes h x v blocks to each MCU
+				for (int i = 0; i < m_ScanComponentCount; i++)
+				{
+					Component& component = m_Components[m_ScanComponents[i]];
+					for (int by = 0; by < component.v; by++)
+					{
+						for (int bx = 0; bx < component.h; bx++)
+						{
+							if (!DecodeBlock(component, coefficients))
+							{
+								return false;
+							}
+							size_t x = (size_t(mx) * component.h + bx) * 8;
+							size_t y = (size_t(my) * component.v + by) * 8;
+							InverseDct(coefficients, t_Planes.data() + component.planeOffset + y * component.planeWidth + x, component.planeWidth);
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	void JpegParser::ConvertColors(unsigned char* pixels) const
+	{
+		for (int y = 0; y < m_Height; y++)
+		{
+			unsigned char* out = pixels + size_t(y) * m_Width * 4;
+			for (int x = 0; x < m_Width; x++, out += 4)
+			{
+				// Subsampled planes are upsampled by replicating samples
+				int samples[maxComponents];
+				for (int i = 0; i < m_ComponentCount; i++)
+				{
+					const Component& component = m_Components[i];
+					size_t sx = size_t(x) * component.h / m_MaxH;
+					size_t sy = size_t(y) * component.v / m_MaxV;
+					samples[i] = t_Planes[component.planeOffset + sy * component.planeWidth + sx];
+				}
+
+				if (m_ComponentCount == 1)
+				{
+					out[0] = out[1] = out[2] = static_cast<unsigned char>(samples[0]);
+				}
+				else if (m_IsAdobeRgb)
+				{
+					out[0] = static_cast<unsigned char>(samples[0]);
+					out[1] = static_cast<unsigned char>(samples[1]);
+					out[2] = static_cast<unsigned char>(samples[2]);
+				}
+				else
+				{
+					// JFIF YCbCr -> RGB in 16.16 fixed point
+					int luma = samples[0] << 16;
+					int cb = samples[1] - 128;
+					int cr = samples[2] - 128;
+					int rgb[3] = {
+						(luma + 91881 * cr + 32768) >> 16,
+						(luma - 22554 * cb - 46802 * cr + 32768) >> 16,
+						(luma + 116130 * cb + 32768) >> 16
+					};
+					for (int channel = 0; channel < 3; channel++)
+					{
+						out[channel] = static_cast<unsigned char>(rgb[channel] < 0 ? 0 : rgb[channel] > 255 ? 255 : rgb[channel]);
+					}
+				}
+				out[3] = 255;
+			}
+		}
+	}
+
+	bool JpegParser::ReadFrame()
+	{
+		size_t payload;
+		size_t payloadSize;
+		while (true)
+		{
+			int marker = NextSegment(payload, payloadSize);
+			switch (marker)
+			{
+			case 0:
+			case 0xD9:
+				std::cerr << "ERROR::IMAGE_DECODER::JPEG_NO_FRAME" << std::endl;
+				return false;
+			// Baseline and extended sequential Huffman coding
+			case 0xC0:
+			case 0xC1:
+				return ReadFrameHeader(payload, payloadSize);
+			case 0xC2:
+				std::cerr << "ERROR::IMAGE_DECODER::JPEG_PROGRESSIVE_UNSUPPORTED" << std::endl;
+				return false;
+			case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+			case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+				std::cerr << "ERROR::IMAGE_DECODER::JPEG_UNSUPPORTED_CODING " << std::hex << marker << std::dec << std::endl;
+				return false;
+			case 0xDB:
+				if (!ReadQuantTables(payload, payloadSize))
+				{
+					return false;
+				}
+				break;
+			case 0xC4:
+				if (!ReadHuffmanTables(payload, payloadSize))
+				{
+					return false;
+				}
+				break;
+			case 0xDD:
+				if (payloadSize < 2)
+				{
+					return false;
+				}
+				m_RestartInterval = ReadWord(payload);
+				break;
+			case 0xEE:
+				// Adobe APP14, transform 0 means the three components are plain RGB
+				if (payloadSize >= 12 && std::memcmp(m_Data + payload, "Adobe", 5) == 0)
+				{
+					m_IsAdobeRgb = m_Data[payload + 11] == 0;
+				}
+				break;
+			default:
+				// APPn, comments and anything else that doesn't change the decoding
+				break;
+			}
+		}
+	}
+
+	bool JpegParser::Decode(unsigned char* pixels)
+	{
+		// Planes sized in whole MCUs so blocks at the right and bottom edge can be written without clipping
+		int mcusX = (m_Width + 8 * m_MaxH - 1) / (8 * m_MaxH);
+		int mcusY = (m_Height + 8 * m_MaxV - 1) / (8 * m_MaxV);
+		size_t planesSize = 0;
+		for (int i = 0; i < m_ComponentCount; i++)
+		{
+			Component& component = m_Components[i];
+			component.planeWidth = mcusX * component.h * 8;
+			component.planeHeight = mcusY * component.v * 8;
+			component.planeOffset = planesSize;
+			planesSize += size_t(component.planeWidth) * component.planeHeight;
+		}
+		t_Planes.assign(planesSize, 0);
+
+		// Tables may still change between the frame header and each scan
+		int decodedComponents = 0;
+		size_t payload;
+		size_t payloadSize;
+		while (true)
+		{
+			int marker = NextSegment(payload, payloadSize);
+			if (marker == 0 || marker == 0xD9)
+			{
+				break;
+			}
+			if (marker == 0xDB && !ReadQuantTables(payload, payloadSize))
+			{
+				return false;
+			}
+			if (marker == 0xC4 && !ReadHuffmanTables(payload, payloadSize))
+			{
+				return false;
+			}
+			if (marker == 0xDD && payloadSize >= 2)
+			{
+				m_RestartInterval = ReadWord(payload);
+			}
+			if (marker != 0xDA)
+			{
+				continue;
+			}
+
+			if (!ReadScanHeader(payload, payloadSize))
+			{
+				std::cerr << "ERROR::IMAGE_DECODER::JPEG_BAD_SCAN" << std::endl;
+				return false;
+			}
+			for (int i = 0; i < m_ScanComponentCount; i++)
+			{
+				const Component& component = m_Components[m_ScanComponents[i]];
+				if (!m_DcTables[component.dcTable].isDefined || !m_AcTables[component.acTable].isDefined)
+				{
+					std::cerr << "ERROR::IMAGE_DECODER::JPEG_MISSING_TABLE" << std::endl;
+					return false;
+				}
+			}
+			if (!DecodeScan())
+			{
+				std::cerr << "ERROR::IMAGE_DECODER::JPEG_BAD_IMAGE_DATA" << std::endl;
+				return false;
+			}
+			decodedComponents += m_ScanComponentCount;
+		}
+
+		if (decodedComponents < m_ComponentCount)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::JPEG_TRUNCATED" << std::endl;
+			return false;
+		}
+		ConvertColors(pixels);
+		return true;
+	}
+}
+
+bool ImageDecoder::ReadJpegInfo(const unsigned char* data, size_t size, ImageInfo& info)
+{
+	JpegParser parser(data, size);
+	if (!parser.ReadFrame())
+	{
+		return false;
+	}
+	info.format = ImageFormat::Jpeg;
+	info.width = parser.GetWidth();
+	info.height = parser.GetHeight();
+	return true;
+}
+
+bool ImageDecoder::DecodeJpeg(const unsigned char* data, size_t size, const ImageInfo& info, unsigned char* pixels)
+{
+	JpegParser parser(data, size);
+	if (!parser.ReadFrame() || parser.GetWidth() != info.width || parser.GetHeight() != info.height)
+	{
+		return false;
+	}
+	return parser.Decode(pixels);
+}
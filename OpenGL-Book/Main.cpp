@@ -1,11 +1,45 @@
 #include <cmath>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
 #include <iostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "GLState.h"
+#include "Framebuffer.h"
+#include "HeadlessContext.h"
+#include "FrameTimer.h"
+#include "Profiler.h"
 #include "ShaderProgram.h"
+#include "ShaderBatch.h"
+#include "ShaderWatcher.h"
+#include "BatchRenderer.h"
+#include "InstanceBuffer.h"
+#include "VertexFormat.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshFile.h"
+#include "ShaderVariants.h"
+#include "UniformBlock.h"
+#include "UniformBufferPool.h"
+#include "RenderQueue.h"
+#include "RenderThread.h"
+#include "JobSystem.h"
+#include "JobBenchmark.h"
+#include "ResourceLoader.h"
+#include "TextureLoader.h"
 
 // #define FULLSCREEN
 // #define DISPLAY_WIREFRAME
+// #define PRINT_FRAME_STATS
+// #define BATCH_STRESS_TEST
+// #define INSTANCING_DEMO
+// #define COMPACT_VERTEX_FORMAT
+// #define INDEXED_GRID_DEMO
+// #define RENDER_THREAD
 
 #ifdef FULLSCREEN
 static int windowWidth = 2560;
@@ -15,12 +49,22 @@ static int windowWidth = 800;
 static int windowHeight = 600;
 #endif
 
-// Called whenever the window is resized -> changes fields and sets viewport
+// U and O toggle the UPSIDE_DOWN / USE_OFFSET keywords of the triangle's shader
+static bool isUpsideDown = false;
+static bool isOffsetEnabled = false;
+
+// Input only sets flags, the frame applies them since GL may belong to the render thread
+#ifdef DISPLAY_WIREFRAME
+static bool isWireframeEnabled = true;
+#else
+static bool isWireframeEnabled = false;
+#endif
+
+// Called whenever the window is resized -> changes fields, the viewport follows on the next frame
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
 	windowWidth = width;
 	windowHeight = height;
-	glViewport(0, 0, width, height);
 }
 
 void PrintWindowDimensions()
@@ -30,12 +74,12 @@ void PrintWindowDimensions()
 
 void ProcessInput(GLFWwindow* window)
 {
-#ifdef DISPLAY_WIREFRAME
-	static bool isWireFrameEnabled = 1;
-#else
-	static bool isWireFrameEnabled = 0;
-#endif
+	PROFILE_FUNCTION();
+
 	static bool isKeyDown = 0;
+	static bool isTraceKeyDown = 0;
+	static bool isUpsideDownKeyDown = 0;
+	static bool isOffsetKeyDown = 0;
 
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
@@ -47,16 +91,7 @@ void ProcessInput(GLFWwindow* window)
 		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
 		{
 			isKeyDown = 1;
-			if (!isWireFrameEnabled)
-			{
-				glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-				isWireFrameEnabled = !isWireFrameEnabled;
-			}
-			else
-			{
-				glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-				isWireFrameEnabled = !isWireFrameEnabled;
-			}
+			isWireframeEnabled = !isWireframeEnabled;
 		}
 	}
 
@@ -64,51 +99,150 @@ void ProcessInput(GLFWwindow* window)
 	{
 		isKeyDown = 0;
 	}
+
+	// T dumps everything the profiler has recorded so far
+	if (!isTraceKeyDown && glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
+	{
+		isTraceKeyDown = 1;
+		Profiler::WriteChromeTrace("trace.json");
+	}
+
+	if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+	{
+		isTraceKeyDown = 0;
+	}
+
+	if (!isUpsideDownKeyDown && glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
+	{
+		isUpsideDownKeyDown = 1;
+		isUpsideDown = !isUpsideDown;
+	}
+
+	if (glfwGetKey(window, GLFW_KEY_U) == GLFW_RELEASE)
+	{
+		isUpsideDownKeyDown = 0;
+	}
+
+	if (!isOffsetKeyDown && glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
+	{
+		isOffsetKeyDown = 1;
+		isOffsetEnabled = !isOffsetEnabled;
+	}
+
+	if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE)
+	{
+		isOffsetKeyDown = 0;
+	}
 	
 }
 
-int main()
+// How the scene is presented: a regular window, or headless into an offscreen framebuffer for a fixed number of frames
+struct RunOptions
 {
-	std::cerr << "stderr is visible" << std::endl;
-	if (!glfwInit())
+	GLFWwindow* window = nullptr;
+	HeadlessContext* headless = nullptr;
+	GLADloadproc loadProc = nullptr;
+	int frameCount = 0;
+	const char* outputPath = nullptr;
+	const char* frameCsvPath = nullptr;
+	const char* tracePath = nullptr;
+	const char* meshPath = nullptr;
+	const char* variantListPath = nullptr;
+	const char* texturePath = nullptr;
+};
+
+// A mesh whose buffers are filled by the ResourceLoader. The VAO can only be made on the GL thread's own context,
+// which Poll() does once the upload's fence has signaled.
+struct StreamedMesh
+{
+	ResourceLoader::Request request = 0;
+	bool isRequested = false;
+
+	// Written by the upload, only read once the request is ready
+	VertexFormat format;
+	unsigned int vertexBuffer = 0;
+	unsigned int indexBuffer = 0;
+	unsigned int indexCount = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+	std::vector<MeshFileSubMesh> subMeshes;
+
+	std::unique_ptr<Mesh> mesh;
+	// Set on the GL thread, read by the thread recording the frame
+	std::atomic<bool> isPolled = false;
+
+	~StreamedMesh()
 	{
-		std::cerr << "glfwInit() failed" << std::endl;
-		return -1;
+		// The mesh owns the buffers once it exists
+		if (!mesh && vertexBuffer)
+		{
+			glDeleteBuffers(1, &vertexBuffer);
+			glDeleteBuffers(1, &indexBuffer);
+		}
 	}
 
-	std::cout << "glfwInit() complete" << std::endl;
-	
-	// Set OpenGL version and set to core mode (modern)
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	void Poll(ResourceLoader& loader)
+	{
+		if (!isRequested || isPolled.load(std::memory_order_relaxed) || !loader.IsReady(request))
+		{
+			return;
+		}
+		if (vertexBuffer)
+		{
+			mesh = std::make_unique<Mesh>(format, vertexBuffer, indexBuffer, indexCount, indexType);
+		}
+		isPolled.store(true, std::memory_order_release);
+	}
 
-	// Create a window
-#ifdef FULLSCREEN
-	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGl", glfwGetPrimaryMonitor(), NULL);
-#else
-	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGl", nullptr, nullptr);
-#endif
-	if (!window)
+	bool IsReady() const
 	{
-		std::cerr << "Failed ot create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
+		return isPolled.load(std::memory_order_acquire) && mesh;
 	}
+};
 
-	glfwMakeContextCurrent(window);
+// A program compiled and linked by the ResourceLoader, handed over to the GL thread like a StreamedMesh
+struct StreamedProgram
+{
+	ResourceLoader::Request request = 0;
+	bool isRequested = false;
 
-	// Initialize GLAD -> I can't say I completely understand this but it works like a black box
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	// Created by the upload, only touched once the request is ready
+	std::unique_ptr<ShaderProgram> program;
+	std::atomic<bool> isPolled = false;
+
+	void Poll(ResourceLoader& loader)
 	{
-		std::cerr << "Failed to initialize GLAD" << std::endl;
-		return -1;
+		if (!isRequested || isPolled.load(std::memory_order_relaxed) || !loader.IsReady(request))
+		{
+			return;
+		}
+		isPolled.store(true, std::memory_order_release);
 	}
 
-	// Set the view port to be the entire window and register the callback to handle resizeing
-	glViewport(0, 0, windowWidth, windowHeight);
-	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+	bool IsReady() const
+	{
+		return isPolled.load(std::memory_order_acquire) && program->IsLinked();
+	}
+};
+
+// Everything that owns GL objects lives in here so it is destroyed before the context goes away
+int RunScene(const RunOptions& options)
+{
+	PROFILE_FUNCTION();
+
+	// Headless contexts have no default framebuffer worth drawing to
+	std::unique_ptr<Framebuffer> offscreen;
+	if (options.headless)
+	{
+		offscreen = std::make_unique<Framebuffer>(windowWidth, windowHeight);
+		if (!offscreen->IsComplete())
+		{
+			return -1;
+		}
+		offscreen->Bind();
+	}
 
+	// Set the view port to be the entire window
+	GLState::Viewport(0, 0, windowWidth, windowHeight);
 
 	float triangle[] = {
 		0.5f, -0.5f, 0.0f, 0.22f, 1.0f, 0.78f,
@@ -130,46 +264,607 @@ int main()
 	glGenVertexArrays(1, &triangleVAO);
 
 	// 1. Bind vertex array object
-	glBindVertexArray(triangleVAO);
+	GLState::BindVertexArray(triangleVAO);
 
 	// 2. Copy verticies into a buffer for OpenGL to use
-	glBindBuffer(GL_ARRAY_BUFFER, triangleVBO); // From this point, any calls to glBufferData() will be on the currently bound buffer (VBO)
+	GLState::BindBuffer(GL_ARRAY_BUFFER, triangleVBO); // From this point, any calls to glBufferData() will be on the currently bound buffer (VBO)
 
-	glBufferData(GL_ARRAY_BUFFER, sizeof(triangle), triangle, GL_STATIC_DRAW); // Push buffer to GPU
+	// The layout of triangle[] is 3 floats of position followed by 3 floats of color
+#ifdef COMPACT_VERTEX_FORMAT
+	// 8 bytes per vertex instead of 24, the positions are already in [-1, 1] so they fit a normalized 10 bit format
+	VertexFormat vertexFormat;
+	vertexFormat.Add(0, VertexAttributeFormat::Int2_10_10_10Rev, 3).Add(1, VertexAttributeFormat::UByte4Norm, 3);
+#else
+	VertexFormat vertexFormat;
+	vertexFormat.Add(0, VertexAttributeFormat::Float3).Add(1, VertexAttributeFormat::Float3);
+#endif
+	std::vector<uint8_t> vertexData = vertexFormat.Pack(triangle, 3, 6);
 
-	// 3. Set the vertex attributes pointers
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
+	glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW); // Push buffer to GPU
 
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); // Set the offset to 3 floats in since thats where color is
-	glEnableVertexAttribArray(1);
+	// 3. Set the vertex attributes pointers, one glVertexAttribPointer per attribute with the offsets worked out by the format
+	vertexFormat.Apply();
 
-	ShaderProgram shader = ShaderProgram("vertex.vert", "fragment.frag");
-	shader.Use();
+	// Shaders compile in the background while the loop below is already running
+	ShaderProgram::EnableParallelCompile(options.loadProc);
+	ShaderBatch shaders;
+	ShaderProgram& shader = shaders.Add("vertex.vert", "fragment.frag");
+#ifdef INSTANCING_DEMO
+	ShaderProgram& instancedShader = shaders.Add("instanced.vert", "fragment.frag");
+#endif
+	bool areShadersLoaded = false;
 
-	shader.SetFloat("offset", 0.0f);
+	// Benchmark runs should only measure steady state frames
+	if (options.headless)
+	{
+		shaders.FinishAll();
+	}
 
-#ifdef DISPLAY_WIREFRAME
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	// Edit vertex.vert / fragment.frag while running and the program gets swapped in on the next frame
+	ShaderWatcher shaderWatcher;
+	if (options.window)
+	{
+		shaderWatcher.Watch(shader);
+	}
+
+	// The Material block in vertex.vert, laid out std140 on the CPU and streamed to binding 0 every frame
+	constexpr unsigned int materialBinding = 0;
+	UniformBlockLayout materialLayout("Material");
+	materialLayout.Add("offset", GL_FLOAT);
+	UniformBlockData material(materialLayout);
+	UniformBufferPool uniformPool;
+
+	// The exercises in vertex.vert as compile time keywords, a variant is only compiled the first time it is drawn.
+	// With --variant-list the variants used last run are compiled up front and the list is updated on exit.
+	ShaderVariants triangleVariants("vertex.vert", "fragment.frag");
+	ShaderKeyword upsideDownKeyword = triangleVariants.AddToggle("UPSIDE_DOWN");
+	ShaderKeyword offsetKeyword = triangleVariants.AddToggle("USE_OFFSET");
+	triangleVariants.SetCreateCallback([&options, &shaderWatcher, &materialLayout](ShaderProgram& program)
+	{
+		// The binding sticks across reloads, only the layout has to be checked again
+		program.SetUniformBlockBinding("Material", materialBinding);
+		auto checkLayout = [&materialLayout](ShaderProgram& variant)
+		{
+			const UniformBlockLayout* block = variant.GetUniformBlock("Material");
+			if (block && !materialLayout.IsCompatible(*block))
+			{
+				std::cerr << "ERROR::UNIFORM_BLOCK::LAYOUT_MISMATCH Material" << std::endl;
+			}
+		};
+		if (program.IsLinked())
+		{
+			checkLayout(program);
+		}
+		if (options.window)
+		{
+			shaderWatcher.Watch(program, checkLayout);
+		}
+	});
+	if (options.variantListPath)
+	{
+		std::cout << "prewarmed " << triangleVariants.Prewarm(options.variantListPath) << " shader variants" << std::endl;
+	}
+
+#ifdef BATCH_STRESS_TEST
+	// A grid of small quads that all go through the batch renderer, 20000 triangles in a single draw call
+	BatchRenderer batchRenderer;
+	constexpr int gridSize = 100;
+#endif
+
+#ifdef INSTANCING_DEMO
+	// The same triangle drawn 10000 times with one draw call, every instance gets its own offset, scale, rotation and tint
+	constexpr unsigned int instanceGridSize = 100;
+	unsigned int instancedVAO;
+	glGenVertexArrays(1, &instancedVAO);
+	GLState::BindVertexArray(instancedVAO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, triangleVBO);
+	vertexFormat.Apply();
+
+	InstanceBuffer instanceBuffer(instancedVAO, 3, instanceGridSize * instanceGridSize);
+	// One set per render queue, see renderQueues below
+	std::vector<InstanceData> instances[2];
+	instances[0].resize(instanceGridSize * instanceGridSize);
+	instances[1].resize(instanceGridSize * instanceGridSize);
+#endif
+
+	// The meshes below stream in on the loader thread while the loop already draws the triangle.
+	// The loader is declared after them so it is joined before they go away.
+	StreamedMesh gridMesh;
+	StreamedMesh fileMesh;
+	StreamedProgram textureShader;
+	ResourceLoader loader(options.window);
+
+#ifdef INDEXED_GRID_DEMO
+	// A grid built as a shuffled triangle soup, the optimizer turns it into an indexed mesh ordered for the vertex cache
+	gridMesh.format.Add(0, VertexAttributeFormat::Float3).Add(1, VertexAttributeFormat::Float3);
+	gridMesh.isRequested = true;
+	gridMesh.request = loader.Run([&gridMesh]()
+	{
+		constexpr int gridQuads = 64;
+		std::vector<BatchVertex> soup;
+		for (int y = 0; y < gridQuads; y++)
+		{
+			for (int x = 0; x < gridQuads; x++)
+			{
+				auto corner = [](int cx, int cy)
+				{
+					float px = -0.9f + 1.8f * cx / gridQuads;
+					float py = -0.9f + 1.8f * cy / gridQuads;
+					return BatchVertex{ px, py, 0.0f, (px + 1.0f) * 0.5f, (py + 1.0f) * 0.5f, 0.5f };
+				};
+				soup.insert(soup.end(), { corner(x, y), corner(x + 1, y), corner(x + 1, y + 1) });
+				soup.insert(soup.end(), { corner(x, y), corner(x + 1, y + 1), corner(x, y + 1) });
+			}
+		}
+		// Scatter the triangles so the input has no locality at all
+		for (size_t i = 0; i < soup.size() / 3; i++)
+		{
+			size_t j = (i * 7919) % (soup.size() / 3);
+			std::swap_ranges(soup.begin() + i * 3, soup.begin() + i * 3 + 3, soup.begin() + j * 3);
+		}
+
+		MeshOptimizationReport report;
+		IndexedMesh indexed = OptimizeMesh(soup.data(), soup.size(), sizeof(BatchVertex), &report);
+		std::cout << "grid mesh: " << report.inputVertices << " -> " << report.uniqueVertices << " vertices, "
+			<< report.triangles << " triangles, ACMR " << report.acmrBefore << " -> " << report.acmrAfter << std::endl;
+
+		gridMesh.vertexBuffer = ResourceLoader::CreateBuffer(indexed.vertices.data(), indexed.vertices.size());
+		gridMesh.indexCount = static_cast<unsigned int>(indexed.indices.size());
+		if (indexed.GetVertexCount() <= 0xFFFF)
+		{
+			std::vector<uint16_t> shortIndices(indexed.indices.begin(), indexed.indices.end());
+			gridMesh.indexBuffer = ResourceLoader::CreateBuffer(shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+			gridMesh.indexType = GL_UNSIGNED_SHORT;
+		}
+		else
+		{
+			gridMesh.indexBuffer = ResourceLoader::CreateBuffer(indexed.indices.data(), indexed.indices.size() * sizeof(uint32_t));
+		}
+	});
 #endif
-	while (!glfwWindowShouldClose(window))
+
+	// A .mesh file is mapped and uploaded straight from the page cache, the mapping is dropped once the GPU has its copy
+	if (options.meshPath)
 	{
-		ProcessInput(window);
+		fileMesh.isRequested = true;
+		fileMesh.request = loader.Run([&fileMesh, path = options.meshPath]()
+		{
+			MeshFile meshFile;
+			if (!meshFile.Open(path))
+			{
+				return;
+			}
+			const MeshFileHeader& header = meshFile.GetHeader();
+			fileMesh.format = meshFile.GetFormat();
+			fileMesh.vertexBuffer = ResourceLoader::CreateBuffer(meshFile.GetVertexData(), static_cast<size_t>(header.vertexCount) * header.vertexStride);
+			fileMesh.indexBuffer = ResourceLoader::CreateBuffer(meshFile.GetIndexData(), static_cast<size_t>(header.indexCount) * header.indexSize);
+			fileMesh.indexCount = header.indexCount;
+			fileMesh.indexType = meshFile.GetIndexType();
+			fileMesh.subMeshes.assign(meshFile.GetSubMeshes(), meshFile.GetSubMeshes() + header.subMeshCount);
+		});
+	}
 
-		// rendering happens here
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+	FrameTimer frameTimer;
+	if (options.frameCsvPath && !frameTimer.OpenCsv(options.frameCsvPath))
+	{
+		std::cerr << "Failed to open " << options.frameCsvPath << std::endl;
+	}
 
-		shader.Use();
+	// The scene is recorded into one queue while the other one may still be executing on the render thread.
+	// Sort key program ids only have to be stable and distinct.
+	enum ProgramId : uint16_t
+	{
+		triangleProgramId,
+		sceneProgramId,
+		instancedProgramId,
+		textureProgramId
+	};
+	RenderQueue renderQueues[2];
+	CommandBuffer sceneCommands;
+	CommandBuffer triangleCommands;
+
+	// Per frame CPU work is split into jobs, the main thread helps out while it waits
+	JobSystem jobs;
+
+	// Images decode on the jobs, the quad shows a white placeholder until the texture is uploaded.
+	// The quad's vertices come from gl_VertexID, core profile still wants a VAO bound.
+	// --texture image.png is drawn on a quad in the top right corner, sampled from unit 0.
+	// The texture and its program are both created on the loader's context.
+	constexpr unsigned int imageTextureUnit = 0;
+	TextureLoader textureLoader(jobs, &loader);
+	TextureLoader::Handle imageTexture = 0;
+	unsigned int textureVAO = 0;
+	if (options.texturePath)
+	{
+		imageTexture = textureLoader.Load(options.texturePath);
+		glGenVertexArrays(1, &textureVAO);
 
-		glBindVertexArray(triangleVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 3);
+		textureShader.isRequested = true;
+		textureShader.request = loader.Run([&textureShader]()
+		{
+			textureShader.program = std::make_unique<ShaderProgram>("texture.vert", "texture.frag");
+			textureShader.program->SetSamplerUnit("image", imageTextureUnit);
+		});
+	}
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+	RenderThread renderThread;
+#ifdef RENDER_THREAD
+	if (options.window)
+	{
+		renderThread.Start(options.window);
 	}
+#endif
+	// With a render thread the main thread never touches GL, it only handles input and records the next frame
+	const bool isThreaded = renderThread.IsRunning();
 
-	glfwTerminate();
+	int frame = 0;
+	while (options.window ? !glfwWindowShouldClose(options.window) : frame < options.frameCount)
+	{
+		PROFILE_SCOPE("Frame");
+		// The frame timer issues GL queries, on the render thread it starts with the frame function
+		if (!isThreaded)
+		{
+			frameTimer.BeginFrame();
+		}
+
+		// Input and recording are timed here and handed to the frame timer with the frame, it may be on the render thread
+		FrameTimer::Clock::time_point inputStart = FrameTimer::Clock::now();
+		if (options.window)
+		{
+			ProcessInput(options.window);
+		}
+		FrameTimer::Clock::time_point recordStart = FrameTimer::Clock::now();
+
+		RenderQueue& renderQueue = renderQueues[frame % 2];
+		{
+			PROFILE_SCOPE("Record");
+			if (gridMesh.IsReady())
+			{
+				sceneCommands.Draw({ MakeSortKey(1, sceneProgramId, 0, 0), &shader, gridMesh.mesh->GetVAO(), GL_TRIANGLES,
+					gridMesh.indexType, 0, gridMesh.indexCount, 1 });
+			}
+
+			if (fileMesh.IsReady())
+			{
+				for (const MeshFileSubMesh& subMesh : fileMesh.subMeshes)
+				{
+					sceneCommands.Draw({ MakeSortKey(2, sceneProgramId, 0, 0), &shader, fileMesh.mesh->GetVAO(), GL_TRIANGLES,
+						fileMesh.indexType, subMesh.firstIndex, subMesh.indexCount, 1 });
+				}
+			}
+
+#ifdef INSTANCING_DEMO
+			std::vector<InstanceData>& frameInstances = instances[frame % 2];
+			JobCounter instancesAnimated;
+			jobs.ParallelFor(frameInstances.size(), 1024, [&frameInstances, frame](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					unsigned int x = static_cast<unsigned int>(i % instanceGridSize);
+					unsigned int y = static_cast<unsigned int>(i / instanceGridSize);
+					InstanceData& instance = frameInstances[i];
+					instance.offsetX = -1.0f + (x + 0.5f) * 2.0f / instanceGridSize;
+					instance.offsetY = -1.0f + (y + 0.5f) * 2.0f / instanceGridSize;
+					instance.scale = 1.5f / instanceGridSize;
+					instance.rotation = frame * 0.02f + i * 0.01f;
+					instance.r = static_cast<float>(x) / instanceGridSize;
+					instance.g = static_cast<float>(y) / instanceGridSize;
+					instance.b = 1.0f;
+				}
+			}, instancesAnimated);
+			jobs.Wait(instancesAnimated);
+			sceneCommands.Draw({ MakeSortKey(3, instancedProgramId, 0, 0), &instancedShader, instancedVAO, GL_TRIANGLES,
+				0, 0, 3, static_cast<unsigned int>(frameInstances.size()) });
+#endif
+			if (textureShader.IsReady())
+			{
+				sceneCommands.Draw({ MakeSortKey(4, textureProgramId, 0, 0), textureShader.program.get(), textureVAO, GL_TRIANGLE_STRIP, 0, 0, 4, 1 });
+			}
+			renderQueue.Submit(sceneCommands);
+		}
+		FrameTimer::Clock::time_point recordEnd = FrameTimer::Clock::now();
+
+		// Key 0 has no keywords set, that's the program the batch already built
+		uint32_t variantKey = ShaderVariants::SetKeyword(0, upsideDownKeyword, isUpsideDown);
+		variantKey = ShaderVariants::SetKeyword(variantKey, offsetKeyword, isOffsetEnabled);
+
+		// Everything that touches GL, runs on the render thread if there is one
+		auto renderFrame = [&, frame, variantKey, width = windowWidth, height = windowHeight, isWireframe = isWireframeEnabled,
+			inputStart, recordStart, recordEnd]()
+		{
+			if (isThreaded)
+			{
+				frameTimer.BeginFrame();
+			}
+			frameTimer.SetPhase(FrameTimer::CpuInput, inputStart, recordStart);
+			frameTimer.SetPhase(FrameTimer::CpuRecord, recordStart, recordEnd);
+
+			// rendering happens here
+			{
+				PROFILE_SCOPE("Draw");
+				PROFILE_GPU_SCOPE("Draw");
+				frameTimer.BeginGpu();
+				GLState::Viewport(0, 0, width, height);
+				GLState::PolygonMode(isWireframe ? GL_LINE : GL_FILL);
+				GLState::ClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+
+				shaderWatcher.Update();
+
+				if (!areShadersLoaded && shaders.Poll())
+				{
+					areShadersLoaded = true;
+					std::cout << "shaders loaded" << std::endl;
+
+					// Catch a VAO that doesn't feed every input the linked program actually reads
+					shader.GetReflection().CheckVertexFormat(vertexFormat);
+#ifdef INSTANCING_DEMO
+					instancedShader.GetReflection().CheckVertexFormat(vertexFormat, InstanceBuffer::attributeLocations);
+#endif
+				}
+
+				// VAOs for meshes the loader finished, they are recorded from the next frame on
+				gridMesh.Poll(loader);
+				fileMesh.Poll(loader);
+				textureShader.Poll(loader);
+
+				// Textures decoded since last frame start their upload. Bound for the whole queue, only the quad samples it
+				textureLoader.Update();
+				if (options.texturePath)
+				{
+					textureLoader.Bind(imageTexture, imageTextureUnit);
+				}
+
+				// Variants compile on first use, so the triangle is only recorded here
+				ShaderProgram& triangleShader = variantKey ? triangleVariants.Get(variantKey) : shader;
+				if (triangleShader.IsLinked())
+				{
+					material.SetFloat("offset", 0.25f);
+					uniformPool.Upload(material, materialBinding);
+				}
+				triangleCommands.Draw({ MakeSortKey(0, triangleProgramId, 0, 0), &triangleShader, triangleVAO, GL_TRIANGLES, 0, 0, 3, 1 });
+				renderQueue.Submit(triangleCommands);
+
+#ifdef INSTANCING_DEMO
+				instanceBuffer.Upload(instances[frame % 2].data(), static_cast<unsigned int>(instances[frame % 2].size()));
+#endif
+				renderQueue.Execute();
+
+#ifdef BATCH_STRESS_TEST
+				for (int y = 0; y < gridSize; y++)
+				{
+					for (int x = 0; x < gridSize; x++)
+					{
+						float left = -1.0f + 2.0f * x / gridSize;
+						float bottom = -1.0f + 2.0f * y / gridSize;
+						float size = 1.6f / gridSize;
+						float r = static_cast<float>(x) / gridSize;
+						float g = static_cast<float>(y) / gridSize;
+						batchRenderer.SubmitQuad(shader,
+							{ left, bottom, 0.0f, r, g, 0.5f },
+							{ left + size, bottom, 0.0f, r, g, 0.5f },
+							{ left + size, bottom + size, 0.0f, r, g, 0.5f },
+							{ left, bottom + size, 0.0f, r, g, 0.5f });
+					}
+				}
+				batchRenderer.Flush();
+#endif
+				frameTimer.EndGpu();
+			}
+			frameTimer.EndPhase(FrameTimer::CpuDraw);
+
+			{
+				PROFILE_SCOPE("Swap");
+				if (options.window)
+				{
+					glfwSwapBuffers(options.window);
+				}
+				else
+				{
+					options.headless->SwapBuffers();
+				}
+			}
+			frameTimer.EndPhase(FrameTimer::CpuSwap);
+			Profiler::CollectGpuZones();
+
+			uniformPool.EndFrame();
+			frameTimer.SetStateStats(GLState::EndFrame());
+			frameTimer.EndFrame();
+
+#ifdef PRINT_FRAME_STATS
+			if ((frame + 1) % 300 == 0)
+			{
+				frameTimer.Print(std::cout);
+			}
+#endif
+		};
+
+		if (isThreaded)
+		{
+			renderThread.Submit(renderFrame);
+		}
+		else
+		{
+			renderFrame();
+		}
+
+		// Events have to be polled on the thread that created the window
+		if (options.window)
+		{
+			glfwPollEvents();
+		}
+		frame++;
+	}
+	renderThread.Stop();
+
+	if (options.headless)
+	{
+		std::cout << frame << " frames" << std::endl;
+		frameTimer.Print(std::cout);
+	}
+
+	if (offscreen && options.outputPath)
+	{
+		offscreen->WritePPM(options.outputPath);
+	}
+
+	if (options.tracePath)
+	{
+		Profiler::WriteChromeTrace(options.tracePath);
+	}
+	Profiler::ReleaseGpuResources();
+
+	if (options.variantListPath)
+	{
+		triangleVariants.SaveUsedKeys(options.variantListPath);
+	}
+
+#ifdef INSTANCING_DEMO
+	GLState::OnVertexArrayDeleted(instancedVAO);
+	glDeleteVertexArrays(1, &instancedVAO);
+#endif
+
+	if (textureVAO)
+	{
+		GLState::OnVertexArrayDeleted(textureVAO);
+		glDeleteVertexArrays(1, &textureVAO);
+	}
+
+	glDeleteVertexArrays(1, &triangleVAO);
+	glDeleteBuffers(1, &triangleVBO);
+	GLState::OnVertexArrayDeleted(triangleVAO);
+	GLState::OnBufferDeleted(triangleVBO);
 
 	return 0;
+}
+
+int RunHeadless(RunOptions options)
+{
+	HeadlessContext context(windowWidth, windowHeight);
+	if (!context.IsValid())
+	{
+		std::cerr << "Failed to create headless context" << std::endl;
+		return -1;
+	}
+
+	if (!gladLoadGLLoader(context.GetLoadProc()))
+	{
+		std::cerr << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+	std::cout << "renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+	options.headless = &context;
+	options.loadProc = context.GetLoadProc();
+	return RunScene(options);
+}
+
+// Usage: OpenGL-Book [--headless] [--frames count] [--output image.ppm] [--frame-csv times.csv] [--trace trace.json] [--mesh model.mesh] [--variant-list variants.txt]
+//                    [--texture image.png] [--bench-jobs [max workers]]
+int main(int argc, char** argv)
+{
+	Profiler::SetThreadName("Main");
+	PROFILE_FUNCTION();
+
+	RunOptions options;
+	options.frameCount = 1000;
+	bool isHeadless = false;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--headless") == 0)
+		{
+			isHeadless = true;
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			options.frameCount = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--output") == 0 && hasValue)
+		{
+			options.outputPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--frame-csv") == 0 && hasValue)
+		{
+			options.frameCsvPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+		{
+			options.tracePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--mesh") == 0 && hasValue)
+		{
+			options.meshPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--variant-list") == 0 && hasValue)
+		{
+			options.variantListPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--texture") == 0 && hasValue)
+		{
+			options.texturePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--bench-jobs") == 0)
+		{
+			// CPU only, no window or context needed
+			unsigned int maxWorkers = hasValue && argv[i + 1][0] != '-' ? std::atoi(argv[++i]) : 0;
+			return RunJobBenchmark(maxWorkers);
+		}
+		else
+		{
+			std::cerr << "Unknown argument " << argv[i] << std::endl;
+		}
+	}
+
+	if (isHeadless)
+	{
+		return RunHeadless(options);
+	}
+
+	std::cerr << "stderr is visible" << std::endl;
+	if (!glfwInit())
+	{
+		std::cerr << "glfwInit() failed" << std::endl;
+		return -1;
+	}
+
+	std::cout << "glfwInit() complete" << std::endl;
+	
+	// Set OpenGL version and set to core mode (modern)
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// Create a window
+#ifdef FULLSCREEN
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGl", glfwGetPrimaryMonitor(), NULL);
+#else
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGl", nullptr, nullptr);
+#endif
+	if (!window)
+	{
+		std::cerr << "Failed ot create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+
+	// Initialize GLAD -> I can't say I completely understand this but it works like a black box
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cerr << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// Register the callback to handle resizeing
+	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+
+	options.window = window;
+	options.loadProc = (GLADloadproc)glfwGetProcAddress;
+	int result = RunScene(options);
+
+	glfwTerminate();
+
+	return result;
 }
\ No newline at end of file
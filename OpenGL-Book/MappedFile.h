@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+// Read only memory mapping of a whole file (mmap / MapViewOfFile). Pages are faulted in straight from the
+// page cache, nothing is copied into the process until it is touched.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const char* path);
+	void Close();
+
+	const unsigned char* GetData() const
+	{
+		return m_Data;
+	}
+
+	size_t GetSize() const
+	{
+		return m_Size;
+	}
+
+private:
+	const unsigned char* m_Data = nullptr;
+	size_t m_Size = 0;
+
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#endif
+};
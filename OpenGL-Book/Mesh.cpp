@@ -0,0 +1,81 @@
+#include <vector>
+#include "GLState.h"
+#include "Mesh.h"
+
+Mesh::Mesh(const VertexFormat& format, const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+	: m_IndexCount(static_cast<unsigned int>(indexCount)), m_IndexType(vertexCount <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT)
+{
+	if (m_IndexType == GL_UNSIGNED_SHORT)
+	{
+		std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+		Upload(format, vertices, vertexCount, shortIndices.data(), sizeof(uint16_t));
+	}
+	else
+	{
+		Upload(format, vertices, vertexCount, indices, sizeof(uint32_t));
+	}
+}
+
+Mesh::Mesh(const VertexFormat& format, const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType)
+	: m_IndexCount(static_cast<unsigned int>(indexCount)), m_IndexType(indexType)
+{
+	Upload(format, vertices, vertexCount, indices, indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+}
+
+Mesh::Mesh(const MeshFile& file)
+	: Mesh(file.GetFormat(), file.GetVertexData(), file.GetHeader().vertexCount, file.GetIndexData(), file.GetHeader().indexCount, file.GetIndexType())
+{
+}
+
+Mesh::Mesh(const VertexFormat& format, const IndexedMesh& mesh)
+	: Mesh(format, mesh.vertices.data(), mesh.GetVertexCount(), mesh.indices.data(), mesh.indices.size())
+{
+}
+
+Mesh::Mesh(const VertexFormat& format, unsigned int vertexBuffer, unsigned int indexBuffer, unsigned int indexCount, GLenum indexType)
+	: m_VBO(vertexBuffer), m_EBO(indexBuffer), m_IndexCount(indexCount), m_IndexType(indexType)
+{
+	glGenVertexArrays(1, &m_VAO);
+	GLState::BindVertexArray(m_VAO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	format.Apply();
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+}
+
+Mesh::~Mesh()
+{
+	GLState::OnVertexArrayDeleted(m_VAO);
+	GLState::OnBufferDeleted(m_VBO);
+	glDeleteVertexArrays(1, &m_VAO);
+	glDeleteBuffers(1, &m_VBO);
+	glDeleteBuffers(1, &m_EBO);
+}
+
+void Mesh::Draw() const
+{
+	Draw(0, m_IndexCount);
+}
+
+void Mesh::Draw(unsigned int firstIndex, unsigned int indexCount) const
+{
+	size_t indexSize = m_IndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+	GLState::BindVertexArray(m_VAO);
+	glDrawElements(GL_TRIANGLES, indexCount, m_IndexType, reinterpret_cast<const void*>(firstIndex * indexSize));
+}
+
+void Mesh::Upload(const VertexFormat& format, const void* vertices, size_t vertexCount, const void* indices, size_t indexSize)
+{
+	glGenVertexArrays(1, &m_VAO);
+	glGenBuffers(1, &m_VBO);
+	glGenBuffers(1, &m_EBO);
+
+	GLState::BindVertexArray(m_VAO);
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * format.GetStride(), vertices, GL_STATIC_DRAW);
+	format.Apply();
+
+	// The element buffer binding is stored in the VAO, so it has to be bound while the VAO is
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_IndexCount * indexSize, indices, GL_STATIC_DRAW);
+}
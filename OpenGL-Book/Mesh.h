@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <glad/glad.h>
+#include "VertexFormat.h"
+#include "MeshOptimizer.h"
+#include "MeshFile.h"
+
+// Indexed triangle mesh on the GPU: VAO, vertex buffer and element buffer.
+// Indices are stored as 16 bit whenever the vertex count allows it.
+class Mesh
+{
+public:
+	Mesh(const VertexFormat& format, const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+
+	// vertexStride of the indexed mesh has to match the format
+	Mesh(const VertexFormat& format, const IndexedMesh& mesh);
+
+	// Uploads indices that are already in their final type (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT) without touching them,
+	// e.g. straight out of a mapped MeshFile
+	Mesh(const VertexFormat& format, const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType);
+
+	Mesh(const MeshFile& file);
+
+	// Takes over buffers that were filled elsewhere, e.g. by a ResourceLoader on a shared context.
+	// VAOs aren't shared between contexts, so only the VAO is created here.
+	Mesh(const VertexFormat& format, unsigned int vertexBuffer, unsigned int indexBuffer, unsigned int indexCount, GLenum indexType);
+
+	~Mesh();
+
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+
+	void Draw() const;
+
+	// Draws a range of the index buffer, e.g. one MeshFileSubMesh
+	void Draw(unsigned int firstIndex, unsigned int indexCount) const;
+
+	unsigned int GetVAO() const
+	{
+		return m_VAO;
+	}
+
+	unsigned int GetIndexCount() const
+	{
+		return m_IndexCount;
+	}
+
+	GLenum GetIndexType() const
+	{
+		return m_IndexType;
+	}
+
+private:
+	void Upload(const VertexFormat& format, const void* vertices, size_t vertexCount, const void* indices, size_t indexSize);
+
+private:
+	unsigned int m_VAO = 0;
+	unsigned int m_VBO = 0;
+	unsigned int m_EBO = 0;
+	unsigned int m_IndexCount;
+	GLenum m_IndexType;
+};
@@ -0,0 +1,188 @@
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include "MeshFile.h"
+
+namespace
+{
+	constexpr uint64_t sectionAlignment = 16;
+
+	uint64_t Align(uint64_t offset)
+	{
+		return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+	}
+
+	bool IsInFile(uint64_t offset, uint64_t size, size_t fileSize)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	}
+
+	// A plain max reduction so it vectorizes, glBufferData reads the same pages right after anyway
+	template<typename T>
+	bool AreIndicesInRange(const unsigned char* data, uint32_t indexCount, uint32_t vertexCount)
+	{
+		const T* indices = reinterpret_cast<const T*>(data);
+		T maxIndex = 0;
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			maxIndex = std::max(maxIndex, indices[i]);
+		}
+		return indexCount == 0 || maxIndex < vertexCount;
+	}
+
+	void WritePadding(std::ofstream& file, uint64_t& position, uint64_t target)
+	{
+		static const char zeros[sectionAlignment] = {};
+		file.write(zeros, static_cast<std::streamsize>(target - position));
+		position = target;
+	}
+}
+
+bool MeshFile::Open(const char* path)
+{
+	m_Header = nullptr;
+	m_Format = VertexFormat();
+
+	if (!m_File.Open(path))
+	{
+		return false;
+	}
+
+	size_t fileSize = m_File.GetSize();
+	const unsigned char* data = m_File.GetData();
+	if (fileSize < sizeof(MeshFileHeader))
+	{
+		std::cerr << "ERROR::MESH_FILE::TRUNCATED " << path << std::endl;
+		return false;
+	}
+
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(data);
+	if (header->magic != meshFileMagic || header->version != meshFileVersion)
+	{
+		std::cerr << "ERROR::MESH_FILE::BAD_HEADER " << path << std::endl;
+		return false;
+	}
+
+	bool isValid = (header->indexSize == 2 || header->indexSize == 4)
+		&& IsInFile(header->attributesOffset, uint64_t(header->attributeCount) * sizeof(MeshFileAttribute), fileSize)
+		&& IsInFile(header->subMeshesOffset, uint64_t(header->subMeshCount) * sizeof(MeshFileSubMesh), fileSize)
+		&& IsInFile(header->vertexDataOffset, uint64_t(header->vertexCount) * header->vertexStride, fileSize)
+		&& IsInFile(header->indexDataOffset, uint64_t(header->indexCount) * header->indexSize, fileSize)
+		&& header->indexDataOffset % header->indexSize == 0;
+	if (!isValid)
+	{
+		std::cerr << "ERROR::MESH_FILE::BAD_SECTIONS " << path << std::endl;
+		return false;
+	}
+
+	// The format is rebuilt by adding the attributes in order, so their offsets have to come out the same
+	const MeshFileAttribute* attributes = reinterpret_cast<const MeshFileAttribute*>(data + header->attributesOffset);
+	for (uint32_t i = 0; i < header->attributeCount; i++)
+	{
+		if (attributes[i].format > static_cast<uint32_t>(VertexAttributeFormat::UByte4Norm) || attributes[i].offset != m_Format.GetStride())
+		{
+			std::cerr << "ERROR::MESH_FILE::BAD_ATTRIBUTE " << path << std::endl;
+			return false;
+		}
+		m_Format.Add(attributes[i].location, static_cast<VertexAttributeFormat>(attributes[i].format));
+	}
+	if (m_Format.GetStride() != header->vertexStride)
+	{
+		std::cerr << "ERROR::MESH_FILE::BAD_STRIDE " << path << std::endl;
+		return false;
+	}
+
+	const MeshFileSubMesh* subMeshes = reinterpret_cast<const MeshFileSubMesh*>(data + header->subMeshesOffset);
+	for (uint32_t i = 0; i < header->subMeshCount; i++)
+	{
+		if (uint64_t(subMeshes[i].firstIndex) + subMeshes[i].indexCount > header->indexCount)
+		{
+			std::cerr << "ERROR::MESH_FILE::BAD_SUBMESH " << path << std::endl;
+			return false;
+		}
+	}
+
+	// An index past the vertex section would have the GPU fetch outside the vertex buffer
+	const unsigned char* indices = data + header->indexDataOffset;
+	bool areIndicesValid = header->indexSize == 2 ? AreIndicesInRange<uint16_t>(indices, header->indexCount, header->vertexCount)
+		: AreIndicesInRange<uint32_t>(indices, header->indexCount, header->vertexCount);
+	if (!areIndicesValid)
+	{
+		std::cerr << "ERROR::MESH_FILE::BAD_INDEX " << path << std::endl;
+		return false;
+	}
+
+	m_Header = header;
+	return true;
+}
+
+bool MeshFile::Write(const char* path, const VertexFormat& format, const void* vertices, uint32_t vertexCount,
+	const uint32_t* indices, uint32_t indexCount, const float boundsMin[3], const float boundsMax[3],
+	std::vector<MeshFileSubMesh> subMeshes)
+{
+	if (subMeshes.empty())
+	{
+		MeshFileSubMesh all = {};
+		all.indexCount = indexCount;
+		std::memcpy(all.boundsMin, boundsMin, sizeof(all.boundsMin));
+		std::memcpy(all.boundsMax, boundsMax, sizeof(all.boundsMax));
+		subMeshes.push_back(all);
+	}
+
+	const std::vector<VertexAttribute>& formatAttributes = format.GetAttributes();
+
+	MeshFileHeader header = {};
+	header.magic = meshFileMagic;
+	header.version = meshFileVersion;
+	header.vertexCount = vertexCount;
+	header.vertexStride = format.GetStride();
+	header.indexCount = indexCount;
+	header.indexSize = vertexCount <= 0xFFFF ? 2 : 4;
+	header.attributeCount = static_cast<uint32_t>(formatAttributes.size());
+	header.subMeshCount = static_cast<uint32_t>(subMeshes.size());
+	std::memcpy(header.boundsMin, boundsMin, sizeof(header.boundsMin));
+	std::memcpy(header.boundsMax, boundsMax, sizeof(header.boundsMax));
+	header.attributesOffset = sizeof(MeshFileHeader);
+	header.subMeshesOffset = header.attributesOffset + header.attributeCount * sizeof(MeshFileAttribute);
+	header.vertexDataOffset = Align(header.subMeshesOffset + header.subMeshCount * sizeof(MeshFileSubMesh));
+	header.indexDataOffset = Align(header.vertexDataOffset + uint64_t(vertexCount) * header.vertexStride);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+
+	uint64_t position = 0;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	position += sizeof(header);
+
+	for (const VertexAttribute& attribute : formatAttributes)
+	{
+		MeshFileAttribute fileAttribute = { attribute.location, static_cast<uint32_t>(attribute.format), attribute.offset, 0 };
+		file.write(reinterpret_cast<const char*>(&fileAttribute), sizeof(fileAttribute));
+		position += sizeof(fileAttribute);
+	}
+
+	file.write(reinterpret_cast<const char*>(subMeshes.data()), subMeshes.size() * sizeof(MeshFileSubMesh));
+	position += subMeshes.size() * sizeof(MeshFileSubMesh);
+
+	WritePadding(file, position, header.vertexDataOffset);
+	file.write(static_cast<const char*>(vertices), uint64_t(vertexCount) * header.vertexStride);
+	position += uint64_t(vertexCount) * header.vertexStride;
+
+	WritePadding(file, position, header.indexDataOffset);
+	if (header.indexSize == 2)
+	{
+		std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+		file.write(reinterpret_cast<const char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		file.write(reinterpret_cast<const char*>(indices), uint64_t(indexCount) * sizeof(uint32_t));
+	}
+
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+#include "MappedFile.h"
+#include "VertexFormat.h"
+
+// Binary mesh file (.mesh), laid out so the vertex and index sections can go to glBufferData straight from the mapping:
+//
+//	MeshFileHeader
+//	MeshFileAttribute[attributeCount]
+//	MeshFileSubMesh[subMeshCount]
+//	vertex data, vertexCount * vertexStride bytes, 16 byte aligned
+//	index data, indexCount 16 or 32 bit indices, 16 byte aligned
+//
+// Everything is little endian, offsets are from the start of the file.
+
+constexpr uint32_t meshFileMagic = 0x4853454D; // "MESH"
+constexpr uint32_t meshFileVersion = 1;
+
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	uint32_t indexSize;			// 2 or 4 bytes
+	uint32_t attributeCount;
+	uint32_t subMeshCount;
+	float boundsMin[3];
+	float boundsMax[3];
+	uint64_t attributesOffset;
+	uint64_t subMeshesOffset;
+	uint64_t vertexDataOffset;
+	uint64_t indexDataOffset;
+};
+
+struct MeshFileAttribute
+{
+	uint32_t location;
+	uint32_t format;			// VertexAttributeFormat
+	uint32_t offset;
+	uint32_t padding;
+};
+
+struct MeshFileSubMesh
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+class MeshFile
+{
+public:
+	// Maps the file and validates every table and section against its size and every index against the vertex count,
+	// nothing is parsed or copied
+	bool Open(const char* path);
+
+	const MeshFileHeader& GetHeader() const
+	{
+		return *m_Header;
+	}
+
+	const VertexFormat& GetFormat() const
+	{
+		return m_Format;
+	}
+
+	const void* GetVertexData() const
+	{
+		return m_File.GetData() + m_Header->vertexDataOffset;
+	}
+
+	const void* GetIndexData() const
+	{
+		return m_File.GetData() + m_Header->indexDataOffset;
+	}
+
+	GLenum GetIndexType() const
+	{
+		return m_Header->indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+
+	const MeshFileSubMesh* GetSubMeshes() const
+	{
+		return reinterpret_cast<const MeshFileSubMesh*>(m_File.GetData() + m_Header->subMeshesOffset);
+	}
+
+	// Indices are narrowed to 16 bit when the vertex count allows it. Without sub-meshes one covering everything is written.
+	static bool Write(const char* path, const VertexFormat& format, const void* vertices, uint32_t vertexCount,
+		const uint32_t* indices, uint32_t indexCount, const float boundsMin[3], const float boundsMax[3],
+		std::vector<MeshFileSubMesh> subMeshes = {});
+
+private:
+	MappedFile m_File;
+	const MeshFileHeader* m_Header = nullptr;
+	VertexFormat m_Format;
+};
@@ -0,0 +1,235 @@
+#include <cstring>
+#include <unordered_map>
+#include "Hash.h"
+#include "MeshOptimizer.h"
+
+IndexedMesh BuildIndexedMesh(const void* vertices, size_t vertexCount, size_t vertexStride)
+{
+	IndexedMesh mesh;
+	mesh.vertexStride = vertexStride;
+	mesh.indices.reserve(vertexCount);
+
+	const uint8_t* src = static_cast<const uint8_t*>(vertices);
+
+	// Hash of the vertex bytes -> indices of the unique vertices with that hash
+	std::unordered_multimap<uint64_t, uint32_t> lookup;
+	lookup.reserve(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const uint8_t* vertex = src + i * vertexStride;
+		uint64_t hash = HashBytes64(vertex, vertexStride);
+
+		uint32_t index = static_cast<uint32_t>(mesh.GetVertexCount());
+		auto range = lookup.equal_range(hash);
+		bool isDuplicate = false;
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (std::memcmp(mesh.vertices.data() + it->second * vertexStride, vertex, vertexStride) == 0)
+			{
+				index = it->second;
+				isDuplicate = true;
+				break;
+			}
+		}
+
+		if (!isDuplicate)
+		{
+			mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + vertexStride);
+			lookup.emplace(hash, index);
+		}
+		mesh.indices.push_back(index);
+	}
+
+	return mesh;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+	// Trailing indices that don't make up a whole triangle are ignored, and dropped from the output
+	size_t indexCount = triangleCount * 3;
+
+	// Vertex -> triangles adjacency in one flat array
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		liveTriangles[indices[i]]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+
+	std::vector<uint32_t> adjacency(indexCount);
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<bool> isEmitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indexCount);
+
+	uint32_t time = cacheSize + 1;
+	size_t cursor = 0;
+
+	auto skipDeadEnd = [&]() -> int64_t
+	{
+		// Most recently used vertices that still have triangles left first, then the next one in input order
+		while (!deadEnds.empty())
+		{
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0)
+			{
+				return vertex;
+			}
+		}
+		while (cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return static_cast<int64_t>(cursor);
+			}
+			cursor++;
+		}
+		return -1;
+	};
+
+	int64_t fanVertex = indices[0];
+	while (fanVertex >= 0)
+	{
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (uint32_t a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; a++)
+		{
+			uint32_t triangle = adjacency[a];
+			if (isEmitted[triangle])
+			{
+				continue;
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - cacheTime[vertex] > cacheSize)
+				{
+					cacheTime[vertex] = time;
+					time++;
+				}
+			}
+			isEmitted[triangle] = true;
+		}
+
+		// Next fan: the candidate that will still be in the cache after its remaining triangles are emitted and has been there longest
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0)
+			{
+				continue;
+			}
+
+			int64_t priority = 0;
+			if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+			{
+				priority = time - cacheTime[vertex];
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		fanVertex = best >= 0 ? best : skipDeadEnd();
+	}
+
+	indices.swap(output);
+}
+
+void OptimizeVertexFetch(IndexedMesh& mesh)
+{
+	constexpr uint32_t unassigned = 0xFFFFFFFF;
+	size_t vertexCount = mesh.GetVertexCount();
+
+	std::vector<uint32_t> remap(vertexCount, unassigned);
+	std::vector<uint8_t> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	uint32_t nextIndex = 0;
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == unassigned)
+		{
+			remap[index] = nextIndex++;
+			const uint8_t* vertex = mesh.vertices.data() + index * mesh.vertexStride;
+			vertices.insert(vertices.end(), vertex, vertex + mesh.vertexStride);
+		}
+		index = remap[index];
+	}
+
+	mesh.vertices.swap(vertices);
+}
+
+float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	if (indices.size() < 3)
+	{
+		return 0.0f;
+	}
+
+	// FIFO: a vertex is a hit if it entered the cache within the last cacheSize misses
+	std::vector<uint32_t> entryTime(vertexCount, 0);
+	uint32_t misses = 0;
+	for (uint32_t index : indices)
+	{
+		if (entryTime[index] == 0 || misses - entryTime[index] >= cacheSize)
+		{
+			misses++;
+			entryTime[index] = misses;
+		}
+	}
+
+	return static_cast<float>(misses) / (indices.size() / 3);
+}
+
+IndexedMesh OptimizeMesh(const void* vertices, size_t vertexCount, size_t vertexStride, MeshOptimizationReport* report)
+{
+	IndexedMesh mesh = BuildIndexedMesh(vertices, vertexCount, vertexStride);
+	size_t uniqueVertices = mesh.GetVertexCount();
+	float acmrBefore = ComputeACMR(mesh.indices, uniqueVertices);
+
+	OptimizeVertexCache(mesh.indices, uniqueVertices);
+	OptimizeVertexFetch(mesh);
+
+	if (report)
+	{
+		report->inputVertices = vertexCount;
+		report->uniqueVertices = uniqueVertices;
+		report->triangles = mesh.indices.size() / 3;
+		report->acmrBefore = acmrBefore;
+		report->acmrAfter = ComputeACMR(mesh.indices, mesh.GetVertexCount());
+	}
+
+	return mesh;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Vertices are opaque blobs of vertexStride bytes, so this works for any VertexFormat
+struct IndexedMesh
+{
+	std::vector<uint8_t> vertices;
+	size_t vertexStride = 0;
+	std::vector<uint32_t> indices;
+
+	size_t GetVertexCount() const
+	{
+		return vertexStride ? vertices.size() / vertexStride : 0;
+	}
+};
+
+struct MeshOptimizationReport
+{
+	size_t inputVertices = 0;
+	size_t uniqueVertices = 0;
+	size_t triangles = 0;
+	float acmrBefore = 0.0f;	// average cache miss ratio, vertices transformed per triangle
+	float acmrAfter = 0.0f;
+};
+
+// Post transform cache size the optimizer and the ACMR report assume, a conservative guess for modern GPUs
+constexpr unsigned int defaultVertexCacheSize = 16;
+
+// Turns a triangle soup into unique vertices plus an index buffer, byte identical vertices are merged
+IndexedMesh BuildIndexedMesh(const void* vertices, size_t vertexCount, size_t vertexStride);
+
+// Reorders triangles for the post transform cache (Tipsify, Sander et al. 2007). Indices past the last whole triangle are dropped.
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = defaultVertexCacheSize);
+
+// Reorders vertices into the order the indices first use them so vertex fetch walks memory linearly,
+// vertices no index refers to are dropped
+void OptimizeVertexFetch(IndexedMesh& mesh);
+
+// Simulates a FIFO cache of cacheSize entries
+float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = defaultVertexCacheSize);
+
+// All of the above in order: index, optimize for the cache, then for fetch
+IndexedMesh OptimizeMesh(const void* vertices, size_t vertexCount, size_t vertexStride, MeshOptimizationReport* report = nullptr);
@@ -0,0 +1,355 @@
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include "Inflate.h"
+#include "ImageDecoder.h"
+
+namespace
+{
+	// Scratch for the concatenated IDAT chunks and the inflated, still filtered scanlines
+	thread_local std::vector<unsigned char> t_Compressed;
+	thread_local std::vector<unsigned char> t_Filtered;
+
+	enum ColorType
+	{
+		Gray = 0,
+		Rgb = 2,
+		Palette = 3,
+		GrayAlpha = 4,
+		Rgba = 6
+	};
+
+	struct PngHeader
+	{
+		uint32_t width;
+		uint32_t height;
+		int bitDepth;
+		int colorType;
+		int channels;
+		bool isInterlaced;
+	};
+
+	uint32_t ReadBigEndian(const unsigned char* data)
+	{
+		return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+	}
+
+	bool IsChunk(const unsigned char* chunk, const char* type)
+	{
+		return std::memcmp(chunk + 4, type, 4) == 0;
+	}
+
+	// The signature is 8 bytes and IHDR has to be the first chunk
+	bool ReadHeader(const unsigned char* data, size_t size, PngHeader& header)
+	{
+		if (size < 8 + 8 + 13 || ReadBigEndian(data + 8) != 13 || !IsChunk(data + 8, "IHDR"))
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::PNG_BAD_HEADER" << std::endl;
+			return false;
+		}
+
+		const unsigned char* fields = data + 16;
+		header.width = ReadBigEndian(fields);
+		header.height = ReadBigEndian(fields + 4);
+		header.bitDepth = fields[8];
+		header.colorType = fields[9];
+		header.isInterlaced = fields[12] != 0;
+
+		bool isValidDepth;
+		switch (header.colorType)
+		{
+		case Gray:
+			header.channels = 1;
+			isValidDepth = header.bitDepth == 1 || header.bitDepth == 2 || header.bitDepth == 4 || header.bitDepth == 8 || header.bitDepth == 16;
+			break;
+		case Palette:
+			header.channels = 1;
+			isValidDepth = header.bitDepth == 1 || header.bitDepth == 2 || header.bitDepth == 4 || header.bitDepth == 8;
+			break;
+		case Rgb:
+			header.channels = 3;
+			isValidDepth = header.bitDepth == 8 || header.bitDepth == 16;
+			break;
+		case GrayAlpha:
+			header.channels = 2;
+			isValidDepth = header.bitDepth == 8 || header.bitDepth == 16;
+			break;
+		case Rgba:
+			header.channels = 4;
+			isValidDepth = header.bitDepth == 8 || header.bitDepth == 16;
+			break;
+		default:
+			isValidDepth = false;
+			break;
+		}
+
+		if (!isValidDepth || fields[10] != 0 || fields[11] != 0)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::PNG_UNSUPPORTED_FORMAT color type " << header.colorType << " depth " << header.bitDepth << std::endl;
+			return false;
+		}
+		if (header.isInterlaced)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::PNG_INTERLACED_UNSUPPORTED" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	int Paeth(int a, int b, int c)
+	{
+		int p = a + b - c;
+		int pa = std::abs(p - a);
+		int pb = std::abs(p - b);
+		int pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc)
+		{
+			return a;
+		}
+		return pb <= pc ? b : c;
+	}
+
+	// Undoes the per scanline filters in place, filtered holds height rows of one filter byte followed by rowSize bytes
+	bool Unfilter(unsigned char* filtered, size_t rowSize, uint32_t height, size_t pixelSize)
+	{
+		const unsigned char* previous = nullptr;
+		for (uint32_t y = 0; y < height; y++)
+		{
+			unsigned char* row = filtered + y * (rowSize + 1) + 1;
+			int filter = row[-1];
+			switch (filter)
+			{
+			case 0:
+				break;
+			case 1:
+				for (size_t i = pixelSize; i < rowSize; i++)
+				{
+					row[i] = static_cast<unsigned char>(row[i] + row[i - pixelSize]);
+				}
+				break;
+			case 2:
+				if (previous)
+				{
+					for (size_t i = 0; i < rowSize; i++)
+					{
+						row[i] = static_cast<unsigned char>(row[i] + previous[i]);
+					}
+				}
+				break;
+			case 3:
+				for (size_t i = 0; i < rowSize; i++)
+				{
+					int left = i >= pixelSize ? row[i - pixelSize] : 0;
+					int up = previous ? previous[i] : 0;
+					row[i] = static_cast<unsigned char>(row[i] + ((left + up) >> 1));
+				}
+				break;
+			case 4:
+				for (size_t i = 0; i < rowSize; i++)
+				{
+					int left = i >= pixelSize ? row[i - pixelSize] : 0;
+					int up = previous ? previous[i] : 0;
+					int upLeft = previous && i >= pixelSize ? previous[i - pixelSize] : 0;
+					row[i] = static_cast<unsigned char>(row[i] + Paeth(left, up, upLeft));
+				}
+				break;
+			default:
+				std::cerr << "ERROR::IMAGE_DECODER::PNG_BAD_FILTER " << filter << std::endl;
+				return false;
+			}
+			previous = row;
+		}
+		return true;
+	}
+
+	// Sample x of a row with bitDepth bits per sample, scaled to 8 bits. 16 bit samples keep their high byte.
+	unsigned int GetSample(const unsigned char* row, size_t x, int bitDepth, bool isScaled)
+	{
+		switch (bitDepth)
+		{
+		case 8:
+			return row[x];
+		case 16:
+			return row[x * 2];
+		default:
+		{
+			size_t bit = x * bitDepth;
+			unsigned int mask = (1u << bitDepth) - 1;
+			unsigned int value = (row[bit / 8] >> (8 - bitDepth - bit % 8)) & mask;
+			// Palette indices stay indices, gray levels are stretched to the full range (e.g. 1 bit: 0 -> 0, 1 -> 255)
+			return isScaled ? value * 255 / mask : value;
+		}
+		}
+	}
+}
+
+bool ImageDecoder::ReadPngInfo(const unsigned char* data, size_t size, ImageInfo& info)
+{
+	PngHeader header;
+	if (!ReadHeader(data, size, header))
+	{
+		return false;
+	}
+	info.format = ImageFormat::Png;
+	info.width = header.width > uint32_t(maxDimension) ? maxDimension + 1 : static_cast<int>(header.width);
+	info.height = header.height > uint32_t(maxDimension) ? maxDimension + 1 : static_cast<int>(header.height);
+	return true;
+}
+
+bool ImageDecoder::DecodePng(const unsigned char* data, size_t size, const ImageInfo& info, unsigned char* pixels)
+{
+	PngHeader header;
+	if (!ReadHeader(data, size, header) || header.width != uint32_t(info.width) || header.height != uint32_t(info.height))
+	{
+		return false;
+	}
+
+	// Walk the chunks, only the palette, transparency and image data matter. CRCs are not checked.
+	unsigned char palette[256 * 4];
+	std::memset(palette, 0xFF, sizeof(palette));
+	int paletteSize = 0;
+	bool hasColorKey = false;
+	unsigned int colorKey[3] = {};
+	const unsigned char* compressed = nullptr;
+	size_t compressedSize = 0;
+	t_Compressed.clear();
+
+	size_t position = 8;
+	while (true)
+	{
+		if (position + 12 > size)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::PNG_TRUNCATED" << std::endl;
+			return false;
+		}
+		const unsigned char* chunk = data + position;
+		size_t length = ReadBigEndian(chunk);
+		if (length > size - position - 12)
+		{
+			std::cerr << "ERROR::IMAGE_DECODER::PNG_TRUNCATED" << std::endl;
+			return false;
+		}
+		const unsigned char* chunkData = chunk + 8;
+
+		if (IsChunk(chunk, "IEND"))
+		{
+			break;
+		}
+		if (IsChunk(chunk, "PLTE"))
+		{
+			paletteSize = static_cast<int>(length / 3 < 256 ? length / 3 : 256);
+			for (int i = 0; i < paletteSize; i++)
+			{
+				std::memcpy(palette + i * 4, chunkData + i * 3, 3);
+			}
+		}
+		else if (IsChunk(chunk, "tRNS"))
+		{
+			if (header.colorType == Palette)
+			{
+				for (size_t i = 0; i < length && i < 256; i++)
+				{
+					palette[i * 4 + 3] = chunkData[i];
+				}
+			}
+			else if ((header.colorType == Gray && length >= 2) || (header.colorType == Rgb && length >= 6))
+			{
+				// The key is compared against the full precision samples, so only exact for depths up to 8
+				hasColorKey = header.bitDepth <= 8;
+				for (int channel = 0; channel < header.channels; channel++)
+				{
+					colorKey[channel] = (chunkData[channel * 2] << 8) | chunkData[channel * 2 + 1];
+				}
+			}
+		}
+		else if (IsChunk(chunk, "IDAT"))
+		{
+			// A single IDAT is inflated in place, several are glued together first
+			if (!compressed)
+			{
+				compressed = chunkData;
+				compressedSize = length;
+			}
+			else
+			{
+				if (t_Compressed.empty())
+				{
+					t_Compressed.assign(compressed, compressed + compressedSize);
+				}
+				t_Compressed.insert(t_Compressed.end(), chunkData, chunkData + length);
+			}
+		}
+		position += length + 12;
+	}
+
+	if (!t_Compressed.empty())
+	{
+		compressed = t_Compressed.data();
+		compressedSize = t_Compressed.size();
+	}
+	if (!compressed || (header.colorType == Palette && paletteSize == 0))
+	{
+		std::cerr << "ERROR::IMAGE_DECODER::PNG_MISSING_CHUNK" << std::endl;
+		return false;
+	}
+
+	size_t rowSize = (static_cast<size_t>(header.width) * header.channels * header.bitDepth + 7) / 8;
+	size_t pixelSize = header.bitDepth < 8 ? 1 : header.channels * header.bitDepth / 8;
+	t_Filtered.resize((rowSize + 1) * header.height);
+	if (!Inflate(compressed, compressedSize, t_Filtered.data(), t_Filtered.size()))
+	{
+		std::cerr << "ERROR::IMAGE_DECODER::PNG_BAD_IMAGE_DATA" << std::endl;
+		return false;
+	}
+	if (!Unfilter(t_Filtered.data(), rowSize, header.height, pixelSize))
+	{
+		return false;
+	}
+
+	bool isScaled = header.colorType != Palette;
+	for (uint32_t y = 0; y < header.height; y++)
+	{
+		const unsigned char* row = t_Filtered.data() + y * (rowSize + 1) + 1;
+		unsigned char* out = pixels + static_cast<size_t>(y) * header.width * 4;
+		for (uint32_t x = 0; x < header.width; x++, out += 4)
+		{
+			switch (header.colorType)
+			{
+			case Gray:
+			{
+				unsigned int gray = GetSample(row, x, header.bitDepth, isScaled);
+				out[0] = out[1] = out[2] = static_cast<unsigned char>(gray);
+				// The key is in the file's own precision, compare against the unscaled sample
+				out[3] = hasColorKey && GetSample(row, x, header.bitDepth, false) == colorKey[0] ? 0 : 255;
+				break;
+			}
+			case Palette:
+			{
+				unsigned int index = GetSample(row, x, header.bitDepth, false);
+				std::memcpy(out, palette + (index < unsigned(paletteSize) ? index : 0) * 4, 4);
+				break;
+			}
+			case Rgb:
+				for (int channel = 0; channel < 3; channel++)
+				{
+					out[channel] = static_cast<unsigned char>(GetSample(row, x * 3 + channel, header.bitDepth, true));
+				}
+				out[3] = hasColorKey && out[0] == colorKey[0] && out[1] == colorKey[1] && out[2] == colorKey[2] ? 0 : 255;
+				break;
+			case GrayAlpha:
+				out[0] = out[1] = out[2] = static_cast<unsigned char>(GetSample(row, x * 2, header.bitDepth, true));
+				out[3] = static_cast<unsigned char>(GetSample(row, x * 2 + 1, header.bitDepth, true));
+				break;
+			case Rgba:
+				for (int channel = 0; channel < 4; channel++)
+				{
+					out[channel] = static_cast<unsigned char>(GetSample(row, x * 4 + channel, header.bitDepth, true));
+				}
+				break;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,282 @@
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <glad/glad.h>
+#include "Profiler.h"
+
+namespace
+{
+	struct ZoneEvent
+	{
+		const char* name;
+		int64_t start;
+		int64_t end;
+	};
+
+	// Only the owning thread writes, it publishes new events through count so a dump from another thread
+	// only ever reads finished entries. Storage is allocated a chunk at a time as the thread records so idle
+	// workers stay small, chunks never move and a full buffer drops events instead of growing.
+	struct ThreadBuffer
+	{
+		static constexpr size_t chunkSize = 1 << 12;
+		static constexpr size_t chunkCount = 64;
+		static constexpr size_t capacity = chunkSize * chunkCount;
+
+		std::unique_ptr<ZoneEvent[]> chunks[chunkCount];
+		std::atomic<size_t> count{ 0 };
+		std::atomic<size_t> dropped{ 0 };
+		std::atomic<const char*> name{ nullptr };
+		int id = 0;
+
+		const ZoneEvent& operator[](size_t index) const
+		{
+			return chunks[index / chunkSize][index % chunkSize];
+		}
+	};
+
+	struct GpuZone
+	{
+		const char* name;
+		unsigned int beginQuery;
+		unsigned int endQuery;
+		bool isOpen;
+	};
+
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	// Registration is the only place that takes a lock, once per thread
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+	// GPU state, only touched from the GL thread
+	ThreadBuffer* gpuBuffer = nullptr;
+	std::vector<GpuZone> gpuZones;
+	std::vector<size_t> openGpuZones;
+	std::vector<unsigned int> freeQueries;
+	// gpu timestamp - cpu timestamp, measured once when the first GPU zone opens
+	int64_t gpuClockOffset = 0;
+	bool isGpuClockCalibrated = false;
+
+	ThreadBuffer* RegisterBuffer(const char* name)
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+		ThreadBuffer* buffer = threadBuffers.back().get();
+		buffer->id = static_cast<int>(threadBuffers.size());
+		buffer->name = name;
+		return buffer;
+	}
+
+	ThreadBuffer& GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = RegisterBuffer(nullptr);
+		return *buffer;
+	}
+
+	void Push(ThreadBuffer& buffer, const ZoneEvent& event)
+	{
+		size_t count = buffer.count.load(std::memory_order_relaxed);
+		if (count == ThreadBuffer::capacity)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		std::unique_ptr<ZoneEvent[]>& chunk = buffer.chunks[count / ThreadBuffer::chunkSize];
+		if (!chunk)
+		{
+			chunk = std::make_unique<ZoneEvent[]>(ThreadBuffer::chunkSize);
+		}
+		chunk[count % ThreadBuffer::chunkSize] = event;
+		buffer.count.store(count + 1, std::memory_order_release);
+	}
+
+	unsigned int AllocateQuery()
+	{
+		if (freeQueries.empty())
+		{
+			unsigned int queries[16];
+			glGenQueries(16, queries);
+			freeQueries.insert(freeQueries.end(), queries, queries + 16);
+		}
+		unsigned int query = freeQueries.back();
+		freeQueries.pop_back();
+		return query;
+	}
+
+	void WriteEscaped(std::ofstream& file, const char* str)
+	{
+		for (; *str; str++)
+		{
+			if (*str == '"' || *str == '\\')
+			{
+				file << '\\';
+			}
+			file << *str;
+		}
+	}
+}
+
+int64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	GetThreadBuffer().name = name;
+}
+
+void Profiler::RecordZone(const char* name, int64_t start, int64_t end)
+{
+	Push(GetThreadBuffer(), { name, start, end });
+}
+
+void Profiler::BeginGpuZone(const char* name)
+{
+	if (!isGpuClockCalibrated)
+	{
+		// GL_TIMESTAMP and steady_clock have unrelated epochs, line them up once so GPU zones sit next to the CPU ones
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		gpuClockOffset = gpuNow - Now();
+		isGpuClockCalibrated = true;
+		gpuBuffer = RegisterBuffer("GPU");
+	}
+
+	GpuZone zone = { name, AllocateQuery(), AllocateQuery(), true };
+	glQueryCounter(zone.beginQuery, GL_TIMESTAMP);
+	openGpuZones.push_back(gpuZones.size());
+	gpuZones.push_back(zone);
+}
+
+void Profiler::EndGpuZone()
+{
+	if (openGpuZones.empty())
+	{
+		return;
+	}
+
+	GpuZone& zone = gpuZones[openGpuZones.back()];
+	openGpuZones.pop_back();
+	glQueryCounter(zone.endQuery, GL_TIMESTAMP);
+	zone.isOpen = false;
+}
+
+void Profiler::CollectGpuZones()
+{
+	// Zones complete in submission order, stop at the first one the GPU hasn't reached yet
+	size_t collected = 0;
+	for (; collected < gpuZones.size(); collected++)
+	{
+		GpuZone& zone = gpuZones[collected];
+		if (zone.isOpen)
+		{
+			break;
+		}
+
+		int isAvailable = 0;
+		glGetQueryObjectiv(zone.endQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+		if (!isAvailable)
+		{
+			break;
+		}
+
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+		Push(*gpuBuffer, { zone.name, static_cast<int64_t>(begin) - gpuClockOffset, static_cast<int64_t>(end) - gpuClockOffset });
+
+		freeQueries.push_back(zone.beginQuery);
+		freeQueries.push_back(zone.endQuery);
+	}
+
+	if (collected == 0)
+	{
+		return;
+	}
+
+	gpuZones.erase(gpuZones.begin(), gpuZones.begin() + collected);
+	for (size_t& index : openGpuZones)
+	{
+		index -= collected;
+	}
+}
+
+void Profiler::ReleaseGpuResources()
+{
+	for (const GpuZone& zone : gpuZones)
+	{
+		freeQueries.push_back(zone.beginQuery);
+		freeQueries.push_back(zone.endQuery);
+	}
+	gpuZones.clear();
+	openGpuZones.clear();
+
+	if (!freeQueries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(freeQueries.size()), freeQueries.data());
+		freeQueries.clear();
+	}
+}
+
+bool Profiler::WriteChromeTrace(const char* path)
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "ERROR::PROFILER::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	// Trace event timestamps are in microseconds
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool isFirst = true;
+	for (const auto& buffer : threadBuffers)
+	{
+		const char* name = buffer->name.load();
+		if (name)
+		{
+			file << (isFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+			WriteEscaped(file, name);
+			file << "\"}}";
+			isFirst = false;
+		}
+
+		size_t count = buffer->count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; i++)
+		{
+			const ZoneEvent& event = (*buffer)[i];
+			file << (isFirst ? "" : ",\n") << "{\"name\":\"";
+			WriteEscaped(file, event.name);
+			file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+				<< ",\"ts\":" << event.start / 1000.0
+				<< ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+			isFirst = false;
+		}
+	}
+	file << "\n]}\n";
+
+	for (const auto& buffer : threadBuffers)
+	{
+		size_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+		if (dropped > 0)
+		{
+			const char* name = buffer->name.load();
+			std::cerr << "ERROR::PROFILER::EVENTS_DROPPED " << dropped << " zones on thread " << buffer->id
+				<< (name ? " " : "") << (name ? name : "") << ", its buffer filled up" << std::endl;
+		}
+	}
+
+	std::cout << "wrote trace " << path << std::endl;
+	return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+// Scoped zone profiler that dumps a chrome://tracing / Perfetto compatible JSON file.
+// Every thread records into its own bounded buffer with no locking (allocated in chunks as it fills, events past the
+// cap are dropped and reported when the trace is written). GPU zones are timestamp queries that get read back a few
+// frames later and put on their own "GPU" track.
+// Zone names must be string literals (or otherwise live until the trace is written).
+// Define DISABLE_PROFILER to compile every macro down to nothing.
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifndef DISABLE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_GPU_SCOPE(name)
+#endif
+
+class Profiler
+{
+public:
+	// Nanoseconds since the profiler started
+	static int64_t Now();
+
+	static void SetThreadName(const char* name);
+
+	static void RecordZone(const char* name, int64_t start, int64_t end);
+
+	// GPU zones can nest but have to be opened and closed on the thread that owns the GL context
+	static void BeginGpuZone(const char* name);
+	static void EndGpuZone();
+
+	// Reads back the GPU zones that are done, call once per frame on the GL thread
+	static void CollectGpuZones();
+
+	// Deletes the query objects, has to happen before the context goes away
+	static void ReleaseGpuResources();
+
+	static bool WriteChromeTrace(const char* path);
+};
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name)
+		: m_Name(name), m_Start(Profiler::Now())
+	{
+	}
+
+	~ProfileScope()
+	{
+		Profiler::RecordZone(m_Name, m_Start, Profiler::Now());
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* m_Name;
+	int64_t m_Start;
+};
+
+class GpuProfileScope
+{
+public:
+	explicit GpuProfileScope(const char* name)
+	{
+		Profiler::BeginGpuZone(name);
+	}
+
+	~GpuProfileScope()
+	{
+		Profiler::EndGpuZone();
+	}
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+};
@@ -0,0 +1,156 @@
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <glad/glad.h>
+#include "Hash.h"
+#include "ProgramBinaryCache.h"
+
+std::string ProgramBinaryCache::s_Directory = "shader_cache";
+
+namespace
+{
+	constexpr uint32_t cacheMagic = 0x42504c47; // "GLPB"
+
+	struct CacheHeader
+	{
+		uint32_t magic;
+		uint32_t format;
+		uint32_t length;
+		uint32_t padding;
+		uint64_t key;
+	};
+
+	uint64_t HashGLString(GLenum name, uint64_t hash)
+	{
+		const char* str = reinterpret_cast<const char*>(glGetString(name));
+		if (str)
+		{
+			hash = HashBytes64(str, std::char_traits<char>::length(str), hash);
+		}
+		// Separator so "ab" + "c" doesn't hash the same as "a" + "bc"
+		const char zero = 0;
+		return HashBytes64(&zero, 1, hash);
+	}
+}
+
+bool ProgramBinaryCache::IsSupported()
+{
+	static const bool isSupported = []()
+	{
+		if (!GLAD_GL_VERSION_4_1)
+		{
+			return false;
+		}
+		int formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		return formatCount > 0;
+	}();
+	return isSupported;
+}
+
+uint64_t ProgramBinaryCache::ComputeKey(std::string_view vertexSrc, std::string_view fragmentSrc)
+{
+	uint64_t hash = HashGLString(GL_VENDOR, HashBytes64(nullptr, 0));
+	hash = HashGLString(GL_RENDERER, hash);
+	hash = HashGLString(GL_VERSION, hash);
+
+	const char zero = 0;
+	hash = HashBytes64(vertexSrc.data(), vertexSrc.size(), hash);
+	hash = HashBytes64(&zero, 1, hash);
+	return HashBytes64(fragmentSrc.data(), fragmentSrc.size(), hash);
+}
+
+std::string ProgramBinaryCache::GetPath(uint64_t key)
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return (std::filesystem::path(s_Directory) / name).string();
+}
+
+unsigned int ProgramBinaryCache::Load(uint64_t key)
+{
+	if (!IsSupported())
+	{
+		return 0;
+	}
+
+	std::ifstream file(GetPath(key), std::ios::binary);
+	if (!file)
+	{
+		return 0;
+	}
+
+	CacheHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != cacheMagic || header.key != key)
+	{
+		return 0;
+	}
+
+	std::vector<char> binary(header.length);
+	if (!file.read(binary.data(), binary.size()))
+	{
+		return 0;
+	}
+
+	unsigned int program = glCreateProgram();
+	glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	// The driver is allowed to reject a binary at any time (e.g. after an update), fall back to compiling in that case
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+void ProgramBinaryCache::Store(unsigned int program, uint64_t key)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	CacheHeader header = {};
+	header.magic = cacheMagic;
+	header.key = key;
+
+	std::vector<char> binary(length);
+	glGetProgramBinary(program, length, nullptr, &header.format, binary.data());
+	header.length = static_cast<uint32_t>(length);
+
+	std::error_code error;
+	std::filesystem::create_directories(s_Directory, error);
+
+	// Write to a temporary file first so a crash mid-write never leaves a truncated entry behind
+	std::string path = GetPath(key);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "ERROR::SHADER_CACHE::CANNOT_WRITE " << tempPath << std::endl;
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), binary.size());
+	}
+
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+	}
+}
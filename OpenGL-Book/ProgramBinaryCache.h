@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary)
+// Entries are keyed by a hash of the shader sources and the GL vendor/renderer/version strings,
+// so a driver update or a different GPU just misses the cache instead of loading a stale binary.
+class ProgramBinaryCache
+{
+public:
+	static void SetDirectory(const std::string& directory)
+	{
+		s_Directory = directory;
+	}
+
+	// Program binaries are core since 4.1, the driver also has to expose at least one format
+	static bool IsSupported();
+
+	static uint64_t ComputeKey(std::string_view vertexSrc, std::string_view fragmentSrc);
+
+	// Returns a linked program or 0 if there is no entry or the driver rejected it
+	static unsigned int Load(uint64_t key);
+
+	// The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	static void Store(unsigned int program, uint64_t key);
+
+private:
+	static std::string GetPath(uint64_t key);
+
+private:
+	static std::string s_Directory;
+};
@@ -0,0 +1,114 @@
+#include "GLState.h"
+#include "Profiler.h"
+#include "ShaderProgram.h"
+#include "RenderQueue.h"
+
+namespace
+{
+	// Bytes per index, first is in indices and glDrawElements wants a byte offset
+	size_t GetIndexSize(GLenum indexType)
+	{
+		switch (indexType)
+		{
+		case GL_UNSIGNED_BYTE: return 1;
+		case GL_UNSIGNED_SHORT: return 2;
+		default: return 4;
+		}
+	}
+}
+
+void RenderQueue::Submit(CommandBuffer& commands)
+{
+	const std::vector<DrawPacket>& packets = commands.GetPackets();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Packets.insert(m_Packets.end(), packets.begin(), packets.end());
+	}
+	commands.Clear();
+}
+
+void RenderQueue::Sort()
+{
+	size_t count = m_Packets.size();
+	m_Sorted.resize(count);
+	m_Scratch.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		m_Sorted[i] = { m_Packets[i].key, static_cast<uint32_t>(i) };
+	}
+
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256] = {};
+		for (const SortEntry& entry : m_Sorted)
+		{
+			histogram[(entry.key >> shift) & 0xFF]++;
+		}
+		if (histogram[(m_Sorted[0].key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& bucket : histogram)
+		{
+			size_t bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+
+		// Stable scatter, equal bytes keep the order of the previous pass
+		for (const SortEntry& entry : m_Sorted)
+		{
+			m_Scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+		}
+		m_Sorted.swap(m_Scratch);
+	}
+}
+
+void RenderQueue::Execute()
+{
+	PROFILE_FUNCTION();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Packets.empty())
+	{
+		return;
+	}
+
+	Sort();
+	for (const SortEntry& entry : m_Sorted)
+	{
+		const DrawPacket& packet = m_Packets[entry.index];
+		if (!packet.program->IsLinked())
+		{
+			continue;
+		}
+
+		// GLState drops the Use / bind when consecutive packets share the program or VAO, which the sort makes likely
+		packet.program->Use();
+		GLState::BindVertexArray(packet.vao);
+		if (packet.indexType)
+		{
+			size_t indexSize = GetIndexSize(packet.indexType);
+			const void* offset = reinterpret_cast<const void*>(packet.first * indexSize);
+			if (packet.instanceCount == 1)
+			{
+				glDrawElements(packet.mode, packet.count, packet.indexType, offset);
+			}
+			else
+			{
+				glDrawElementsInstanced(packet.mode, packet.count, packet.indexType, offset, packet.instanceCount);
+			}
+		}
+		else if (packet.instanceCount == 1)
+		{
+			glDrawArrays(packet.mode, packet.first, packet.count);
+		}
+		else
+		{
+			glDrawArraysInstanced(packet.mode, packet.first, packet.count, packet.instanceCount);
+		}
+	}
+	m_Packets.clear();
+}
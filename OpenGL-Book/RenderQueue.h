@@ -0,0 +1,95 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+
+class ShaderProgram;
+
+// 64 bit sort key, most significant first: layer 8 bits, program 16, material 16, depth 24.
+// Sorting by it keeps layers in order, then groups draws by program and material so state changes are rare,
+// and orders each group by depth last.
+constexpr uint64_t MakeSortKey(uint8_t layer, uint16_t program, uint16_t material, uint32_t depth)
+{
+	return (static_cast<uint64_t>(layer) << 56) | (static_cast<uint64_t>(program) << 40)
+		| (static_cast<uint64_t>(material) << 24) | (depth & 0xFFFFFF);
+}
+
+// View space depth in [0, 1] to the 24 bits of the key, pass 1 - depth to sort back to front
+inline uint32_t QuantizeDepth(float depth)
+{
+	depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+	return static_cast<uint32_t>(depth * 0xFFFFFF);
+}
+
+// Everything one draw call needs, recorded without touching GL
+struct DrawPacket
+{
+	uint64_t key;
+	const ShaderProgram* program;	// skipped while the program isn't linked
+	unsigned int vao;
+	GLenum mode;
+	GLenum indexType;				// GL_UNSIGNED_BYTE / SHORT / INT, 0 for glDrawArrays
+	unsigned int first;				// first vertex, or first index for indexed draws
+	unsigned int count;
+	unsigned int instanceCount;		// 1 for non instanced draws
+};
+
+// Packets recorded by one thread, no locking. Hand it to a RenderQueue with Submit() once the thread is done.
+class CommandBuffer
+{
+public:
+	void Draw(const DrawPacket& packet)
+	{
+		m_Packets.push_back(packet);
+	}
+
+	void Clear()
+	{
+		m_Packets.clear();
+	}
+
+	const std::vector<DrawPacket>& GetPackets() const
+	{
+		return m_Packets;
+	}
+
+private:
+	std::vector<DrawPacket> m_Packets;
+};
+
+// The draws of one frame. Command buffers are submitted from any thread, the thread owning the context
+// radix sorts all packets by key and issues them with Execute(). Keep two and alternate between them
+// so the next frame can be recorded while this one is executed (see RenderThread).
+class RenderQueue
+{
+public:
+	// Copies the packets over and clears the command buffer so it can be reused for the next frame
+	void Submit(CommandBuffer& commands);
+
+	// Sorts and draws everything submitted so far, then empties the queue. Only on the thread owning the context.
+	void Execute();
+
+	size_t GetPacketCount() const
+	{
+		return m_Packets.size();
+	}
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	// LSD radix sort, 8 bits per pass. Passes where every key has the same byte are skipped,
+	// which with few programs and materials is most of them.
+	void Sort();
+
+private:
+	std::mutex m_Mutex;
+	std::vector<DrawPacket> m_Packets;
+	std::vector<SortEntry> m_Sorted;
+	std::vector<SortEntry> m_Scratch;
+};
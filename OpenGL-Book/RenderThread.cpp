@@ -0,0 +1,96 @@
+#include "GLState.h"
+#include <GLFW/glfw3.h>
+#include "Profiler.h"
+#include "RenderThread.h"
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Start(GLFWwindow* window)
+{
+	if (IsRunning())
+	{
+		return;
+	}
+
+	// A context can only be current on one thread at a time
+	m_Window = window;
+	glfwMakeContextCurrent(nullptr);
+
+	m_IsRunning = true;
+	m_Thread = std::thread(&RenderThread::ThreadMain, this);
+}
+
+void RenderThread::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsRunning = false;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	// The render thread changed bindings this thread's cache never saw
+	glfwMakeContextCurrent(m_Window);
+	GLState::Invalidate();
+}
+
+void RenderThread::Submit(std::function<void()> frame)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]()
+	{
+		return !m_Frame;
+	});
+	m_Frame = std::move(frame);
+	lock.unlock();
+	m_Condition.notify_all();
+}
+
+void RenderThread::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]()
+	{
+		return !m_Frame;
+	});
+}
+
+void RenderThread::ThreadMain()
+{
+	Profiler::SetThreadName("Render");
+	// Comes with whatever the main thread left bound, this thread's cache starts out knowing nothing about it
+	glfwMakeContextCurrent(m_Window);
+	GLState::Invalidate();
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_Condition.wait(lock, [this]()
+		{
+			return !m_IsRunning || m_Frame;
+		});
+		// A frame queued before Stop() still runs, the caller may be waiting on it
+		if (!m_Frame)
+		{
+			break;
+		}
+
+		// The frame stays in m_Frame while it runs so Submit() / Wait() keep blocking until it is done
+		lock.unlock();
+		m_Frame();
+		lock.lock();
+
+		m_Frame = nullptr;
+		m_Condition.notify_all();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+struct GLFWwindow;
+
+// A thread that owns the window's GL context and runs one frame function at a time.
+// Submit() only waits for the previous frame, so the caller records frame N + 1 while frame N is submitted to GL.
+class RenderThread
+{
+public:
+	RenderThread() = default;
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	// Takes the context away from the calling thread, nothing may touch GL there until Stop()
+	void Start(GLFWwindow* window);
+
+	// Finishes the queued frame and makes the context current on the calling thread again
+	void Stop();
+
+	bool IsRunning() const
+	{
+		return m_Thread.joinable();
+	}
+
+	// Blocks until the previously submitted frame is done, then queues this one
+	void Submit(std::function<void()> frame);
+
+	// Blocks until the queued frame is done
+	void Wait();
+
+private:
+	void ThreadMain();
+
+private:
+	GLFWwindow* m_Window = nullptr;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::function<void()> m_Frame;
+	bool m_IsRunning = false;
+	std::thread m_Thread;
+};
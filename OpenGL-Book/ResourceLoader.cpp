@@ -0,0 +1,177 @@
+#include <iostream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "GLState.h"
+#include "Profiler.h"
+#include "ResourceLoader.h"
+
+ResourceLoader::ResourceLoader(GLFWwindow* sharedWindow)
+{
+	if (!sharedWindow)
+	{
+		return;
+	}
+
+	// Same version as the main window, the last argument makes the contexts share objects
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_Window = glfwCreateWindow(1, 1, "Loader", nullptr, sharedWindow);
+	glfwDefaultWindowHints();
+
+	if (!m_Window)
+	{
+		std::cerr << "ERROR::RESOURCE_LOADER::CANNOT_CREATE_SHARED_CONTEXT, loading inline" << std::endl;
+		return;
+	}
+	m_Thread = std::thread(&ResourceLoader::ThreadMain, this);
+}
+
+ResourceLoader::~ResourceLoader()
+{
+	if (!m_Window)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsRunning = false;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	// Fences are shared objects, the ones nobody polled to the end are deleted through the main context
+	for (PendingUpload& upload : m_Uploads)
+	{
+		if (upload.isFenced.load(std::memory_order_acquire) && !upload.isReady)
+		{
+			glDeleteSync(upload.fence);
+		}
+	}
+	glfwDestroyWindow(m_Window);
+}
+
+ResourceLoader::Request ResourceLoader::Run(std::function<void()> upload)
+{
+	Request request;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		request = m_Uploads.size();
+		m_Uploads.emplace_back();
+		m_Uploads.back().upload = std::move(upload);
+	}
+
+	if (!m_Window)
+	{
+		PendingUpload& pending = m_Uploads[request];
+		pending.upload();
+		pending.upload = nullptr;
+		pending.isReady = true;
+		return request;
+	}
+
+	m_Condition.notify_all();
+	return request;
+}
+
+ResourceLoader::PendingUpload& ResourceLoader::GetUpload(Request request)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Uploads[request];
+}
+
+bool ResourceLoader::IsReady(Request request)
+{
+	PendingUpload& pending = GetUpload(request);
+	if (pending.isReady)
+	{
+		return true;
+	}
+	if (!pending.isFenced.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	// Timeout 0 only asks, the loader already flushed so the fence is guaranteed to signal eventually
+	GLenum result = glClientWaitSync(pending.fence, 0, 0);
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+	{
+		return false;
+	}
+
+	OnReady(pending);
+	return true;
+}
+
+void ResourceLoader::Wait(Request request)
+{
+	PendingUpload& pending = GetUpload(request);
+	if (pending.isReady)
+	{
+		return;
+	}
+
+	// The fence only exists once the upload ran, that part can't be waited on through GL
+	while (!pending.isFenced.load(std::memory_order_acquire))
+	{
+		std::this_thread::yield();
+	}
+	glClientWaitSync(pending.fence, 0, GL_TIMEOUT_IGNORED);
+	OnReady(pending);
+}
+
+void ResourceLoader::OnReady(PendingUpload& pending)
+{
+	glDeleteSync(pending.fence);
+	pending.fence = nullptr;
+	pending.isReady = true;
+}
+
+unsigned int ResourceLoader::CreateBuffer(const void* data, size_t size, GLenum usage)
+{
+	// Through GLState since inline requests run on the main context. On the loader thread the cache is that thread's own.
+	unsigned int buffer;
+	glGenBuffers(1, &buffer);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, data, usage);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	return buffer;
+}
+
+void ResourceLoader::ThreadMain()
+{
+	Profiler::SetThreadName("Resource Loader");
+	glfwMakeContextCurrent(m_Window);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_Condition.wait(lock, [this]()
+		{
+			return !m_IsRunning || m_NextUpload < m_Uploads.size();
+		});
+		if (!m_IsRunning)
+		{
+			break;
+		}
+
+		// Growing a deque at the back never moves existing elements, so the upload can run without the lock
+		PendingUpload& pending = m_Uploads[m_NextUpload++];
+		lock.unlock();
+		{
+			PROFILE_SCOPE("Upload");
+			pending.upload();
+			pending.upload = nullptr;
+		}
+
+		// The flush gets the fence to the GPU, otherwise waiting on it from the other context could wait forever
+		pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+		pending.isFenced.store(true, std::memory_order_release);
+		lock.lock();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
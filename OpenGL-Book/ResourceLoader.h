@@ -0,0 +1,77 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+#include <glad/glad.h>
+
+struct GLFWwindow;
+
+// Creates GL objects on a loader thread with its own context shared with the window's, so loading doesn't hold up
+// the frame loop. Buffers, textures, programs and fences are shared between the contexts, VAOs and framebuffers
+// are not: build those on the main context once the request is ready.
+class ResourceLoader
+{
+public:
+	using Request = size_t;
+
+	// Creates the hidden shared window, so it has to be called on the thread that created sharedWindow.
+	// Without a window (headless) every request simply runs inline on the calling thread.
+	explicit ResourceLoader(GLFWwindow* sharedWindow);
+	~ResourceLoader();
+
+	ResourceLoader(const ResourceLoader&) = delete;
+	ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+	bool IsThreaded() const
+	{
+		return m_Window != nullptr;
+	}
+
+	// Runs upload on the loader thread with the loader context current and fences everything it issued.
+	// CPU work that produces the data (reading, decoding, optimizing) belongs in there as well, so does compiling
+	// and linking a program or allocating and filling a texture.
+	// Binds go through GLState like everywhere else, its cache is per thread so it follows whichever context runs the upload.
+	Request Run(std::function<void()> upload);
+
+	// Polls the request's fence without blocking. Once it returns true, whatever the upload created can be used
+	// on the calling thread's context and the upload's results can be read.
+	bool IsReady(Request request);
+
+	// Blocks until the request is ready, for owners that go away while their uploads may still be running
+	void Wait(Request request);
+
+	// Plain buffer upload for use inside Run(), bound to GL_COPY_WRITE_BUFFER since buffer objects aren't typed
+	static unsigned int CreateBuffer(const void* data, size_t size, GLenum usage = GL_STATIC_DRAW);
+
+private:
+	struct PendingUpload
+	{
+		std::function<void()> upload;
+		GLsync fence = nullptr;
+		std::atomic<bool> isFenced = false;
+		bool isReady = false;
+	};
+
+	PendingUpload& GetUpload(Request request);
+	// Called once the fence signaled, on the thread that polled it
+	void OnReady(PendingUpload& pending);
+
+	void ThreadMain();
+
+private:
+	GLFWwindow* m_Window = nullptr;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	// A deque keeps the uploads in place while the loader fills in their fences
+	std::deque<PendingUpload> m_Uploads;
+	size_t m_NextUpload = 0;
+
+	bool m_IsRunning = true;
+	std::thread m_Thread;
+};
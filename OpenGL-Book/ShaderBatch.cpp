@@ -0,0 +1,69 @@
+#include "ShaderBatch.h"
+
+ShaderProgram& ShaderBatch::Add(const char* vertexPath, const char* fragmentPath)
+{
+	Entry entry;
+	entry.program = ShaderProgram::CreateUnloaded(vertexPath, fragmentPath);
+	entry.vertexSource = m_Loader.Request(vertexPath);
+	entry.fragmentSource = m_Loader.Request(fragmentPath);
+	m_Programs.push_back(std::move(entry));
+	return *m_Programs.back().program;
+}
+
+bool ShaderBatch::TryLoad(Entry& entry)
+{
+	if (entry.program->IsLoaded())
+	{
+		return true;
+	}
+
+	if (!m_Loader.IsLoaded(entry.vertexSource) || !m_Loader.IsLoaded(entry.fragmentSource))
+	{
+		return false;
+	}
+
+	entry.program->Load(m_Loader.Get(entry.vertexSource), m_Loader.Get(entry.fragmentSource), true);
+	return true;
+}
+
+bool ShaderBatch::Poll()
+{
+	for (size_t i = m_FinishedCount; i < m_Programs.size(); i++)
+	{
+		if (!TryLoad(m_Programs[i]) || !m_Programs[i].program->IsReady())
+		{
+			continue;
+		}
+
+		m_Programs[i].program->Finish();
+
+		// Keep the finished programs packed at the front so later polls skip them
+		std::swap(m_Programs[i], m_Programs[m_FinishedCount]);
+		m_FinishedCount++;
+
+		// Without completion status polling every Finish() can stall, so only pay for one per frame
+		if (!ShaderProgram::HasParallelCompile())
+		{
+			break;
+		}
+	}
+
+	return m_FinishedCount == m_Programs.size();
+}
+
+void ShaderBatch::FinishAll()
+{
+	// Submit everything before finishing anything so the driver can compile in parallel
+	for (size_t i = m_FinishedCount; i < m_Programs.size(); i++)
+	{
+		m_Loader.Wait(m_Programs[i].vertexSource);
+		m_Loader.Wait(m_Programs[i].fragmentSource);
+		TryLoad(m_Programs[i]);
+	}
+
+	for (size_t i = m_FinishedCount; i < m_Programs.size(); i++)
+	{
+		m_Programs[i].program->Finish();
+	}
+	m_FinishedCount = m_Programs.size();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "ShaderProgram.h"
+#include "ShaderSource.h"
+
+// Reads the sources of a whole set of programs on a loader thread, submits each program as soon as its files are in
+// and finishes them as the driver reports them complete, so loading many shaders never blocks a frame on file IO or a single compile
+class ShaderBatch
+{
+public:
+	// The files are queued for the loader thread, the program can't be used until IsLinked() returns true
+	ShaderProgram& Add(const char* vertexPath, const char* fragmentPath);
+
+	// Submits programs whose sources have been read and finishes every program that is done compiling,
+	// returns true once the whole batch is finished
+	bool Poll();
+
+	// Blocks until every program is loaded and finished
+	void FinishAll();
+
+	// Deletes every program, has to happen while the context is still alive
+	void Clear()
+	{
+		m_Programs.clear();
+		m_FinishedCount = 0;
+	}
+
+	size_t GetFinishedCount() const
+	{
+		return m_FinishedCount;
+	}
+
+	size_t GetCount() const
+	{
+		return m_Programs.size();
+	}
+
+private:
+	struct Entry
+	{
+		std::unique_ptr<ShaderProgram> program;
+		size_t vertexSource;
+		size_t fragmentSource;
+	};
+
+	// Hands the sources over once both files are read, returns false while they are still loading
+	bool TryLoad(Entry& entry);
+
+private:
+	ShaderSourceLoader m_Loader;
+	std::vector<Entry> m_Programs;
+	// Programs before this index are finished, the rest are still compiling in submission order
+	size_t m_FinishedCount = 0;
+};
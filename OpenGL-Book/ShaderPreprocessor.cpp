@@ -0,0 +1,342 @@
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include "ShaderSource.h"
+#include "ShaderPreprocessor.h"
+
+std::mutex ShaderPreprocessor::s_Mutex;
+std::vector<std::string> ShaderPreprocessor::s_IncludeDirectories;
+std::unordered_map<std::string, std::shared_ptr<const ShaderPreprocessor::ParsedFile>> ShaderPreprocessor::s_Files;
+
+namespace
+{
+	constexpr int maxIncludeDepth = 32;
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	void SkipSpaces(const std::string& text, size_t& i, size_t end)
+	{
+		while (i < end && IsSpace(text[i]))
+		{
+			i++;
+		}
+	}
+
+	bool MatchWord(const std::string& text, size_t& i, size_t end, std::string_view word)
+	{
+		if (text.compare(i, word.size(), word) != 0 || i + word.size() > end)
+		{
+			return false;
+		}
+		size_t after = i + word.size();
+		if (after < end && !IsSpace(text[after]) && text[after] != '"' && text[after] != '<')
+		{
+			return false;
+		}
+		i = after;
+		return true;
+	}
+}
+
+struct ShaderPreprocessor::ExpandContext
+{
+	const std::vector<ShaderDefine>& defines;
+	PreprocessedShader& result;
+	std::vector<std::string> includeStack;
+	std::vector<std::string> includedOnce;
+};
+
+void ShaderPreprocessor::AddIncludeDirectory(const std::string& directory)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_IncludeDirectories.push_back(directory);
+}
+
+std::string ShaderPreprocessor::NormalizePath(const std::string& path)
+{
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::string ShaderPreprocessor::ResolveInclude(const std::string& includingPath, const std::string& name, bool isSystem)
+{
+	std::error_code error;
+	if (!isSystem)
+	{
+		std::filesystem::path candidate = std::filesystem::path(includingPath).parent_path() / name;
+		if (std::filesystem::is_regular_file(candidate, error))
+		{
+			return NormalizePath(candidate.generic_string());
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	for (const std::string& directory : s_IncludeDirectories)
+	{
+		std::filesystem::path candidate = std::filesystem::path(directory) / name;
+		if (std::filesystem::is_regular_file(candidate, error))
+		{
+			return NormalizePath(candidate.generic_string());
+		}
+	}
+	return std::string();
+}
+
+std::shared_ptr<const ShaderPreprocessor::ParsedFile> ShaderPreprocessor::Parse(const std::string& path, std::string text)
+{
+	// Splits the file at #include, #version and #pragma once lines, everything else is copied through untouched
+	auto file = std::make_shared<ParsedFile>();
+	file->text = std::move(text);
+	const std::string& source = file->text;
+
+	size_t textBegin = 0;
+	unsigned int line = 1;
+	for (size_t lineBegin = 0; lineBegin < source.size(); line++)
+	{
+		size_t lineEnd = source.find('\n', lineBegin);
+		lineEnd = lineEnd == std::string::npos ? source.size() : lineEnd;
+		size_t next = std::min(lineEnd + 1, source.size());
+
+		size_t i = lineBegin;
+		SkipSpaces(source, i, lineEnd);
+		if (i >= lineEnd || source[i] != '#')
+		{
+			lineBegin = next;
+			continue;
+		}
+		i++;
+		SkipSpaces(source, i, lineEnd);
+
+		auto closeText = [&]()
+		{
+			if (lineBegin > textBegin)
+			{
+				file->segments.push_back({ Segment::Text, textBegin, lineBegin, {}, {}, 0 });
+			}
+			textBegin = next;
+		};
+
+		if (MatchWord(source, i, lineEnd, "include"))
+		{
+			SkipSpaces(source, i, lineEnd);
+			char close = i < lineEnd && source[i] == '<' ? '>' : '"';
+			size_t nameEnd = i < lineEnd ? source.find(close, i + 1) : std::string::npos;
+			if (i >= lineEnd || (source[i] != '"' && source[i] != '<') || nameEnd == std::string::npos || nameEnd > lineEnd)
+			{
+				std::cerr << "ERROR::SHADER_PREPROCESSOR::BAD_INCLUDE " << path << ":" << line << std::endl;
+				lineBegin = next;
+				continue;
+			}
+
+			closeText();
+			Segment segment = { Segment::Include, 0, 0, {}, source.substr(i + 1, nameEnd - i - 1), line + 1 };
+			segment.path = ResolveInclude(path, segment.name, close == '>');
+			file->segments.push_back(std::move(segment));
+		}
+		else if (MatchWord(source, i, lineEnd, "version"))
+		{
+			closeText();
+			file->segments.push_back({ Segment::Version, lineBegin, next, {}, {}, line + 1 });
+			file->hasVersion = true;
+		}
+		else if (MatchWord(source, i, lineEnd, "pragma"))
+		{
+			SkipSpaces(source, i, lineEnd);
+			if (MatchWord(source, i, lineEnd, "once"))
+			{
+				closeText();
+				file->segments.push_back({ Segment::Blank, 0, 0, {}, {}, line + 1 });
+				file->isIncludedOnce = true;
+			}
+		}
+		lineBegin = next;
+	}
+
+	if (source.size() > textBegin)
+	{
+		file->segments.push_back({ Segment::Text, textBegin, source.size(), {}, {}, 0 });
+	}
+	return file;
+}
+
+std::shared_ptr<const ShaderPreprocessor::ParsedFile> ShaderPreprocessor::GetFile(const std::string& path)
+{
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		auto it = s_Files.find(path);
+		if (it != s_Files.end())
+		{
+			return it->second;
+		}
+	}
+
+	// Read and parse without the lock, two threads racing on the same file just parse it twice
+	ShaderSource source;
+	if (!source.Load(path.c_str()))
+	{
+		return nullptr;
+	}
+	std::shared_ptr<const ParsedFile> file = Parse(path, std::string(source.GetText()));
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	return s_Files.emplace(path, std::move(file)).first->second;
+}
+
+void ShaderPreprocessor::UpdateFile(const std::string& path, std::string source)
+{
+	std::string normalizedPath = NormalizePath(path);
+	std::shared_ptr<const ParsedFile> file = Parse(normalizedPath, std::move(source));
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Files[normalizedPath] = std::move(file);
+}
+
+void ShaderPreprocessor::Invalidate(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Files.erase(NormalizePath(path));
+}
+
+void ShaderPreprocessor::Clear()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Files.clear();
+}
+
+bool ShaderPreprocessor::Process(const std::string& path, const std::vector<ShaderDefine>& defines, PreprocessedShader& result)
+{
+	std::string normalizedPath = NormalizePath(path);
+	std::shared_ptr<const ParsedFile> file = GetFile(normalizedPath);
+	if (!file)
+	{
+		return false;
+	}
+
+	result = PreprocessedShader();
+	result.files.push_back(normalizedPath);
+	ExpandContext context = { defines, result, { normalizedPath }, {} };
+	return Expand(*file, 0, context, 0);
+}
+
+bool ShaderPreprocessor::Process(const std::string& path, std::string_view source, const std::vector<ShaderDefine>& defines, PreprocessedShader& result)
+{
+	std::string normalizedPath = NormalizePath(path);
+	std::shared_ptr<const ParsedFile> file = Parse(normalizedPath, std::string(source));
+
+	result = PreprocessedShader();
+	result.files.push_back(normalizedPath);
+	ExpandContext context = { defines, result, { normalizedPath }, {} };
+	return Expand(*file, 0, context, 0);
+}
+
+bool ShaderPreprocessor::Expand(const ParsedFile& file, size_t fileIndex, ExpandContext& context, int depth)
+{
+	std::string& output = context.result.source;
+	auto appendDefines = [&context, &output](unsigned int nextLine, size_t fileIndex)
+	{
+		for (const ShaderDefine& define : context.defines)
+		{
+			output += "#define " + define.name + " " + define.value + "\n";
+		}
+		output += "#line " + std::to_string(nextLine) + " " + std::to_string(fileIndex) + "\n";
+	};
+
+	if (depth == 0)
+	{
+		// Expanded sources are mostly the root file plus a few headers
+		output.reserve(file.text.size() * 2);
+		if (!file.hasVersion && !context.defines.empty())
+		{
+			appendDefines(1, fileIndex);
+		}
+	}
+
+	for (const Segment& segment : file.segments)
+	{
+		switch (segment.type)
+		{
+		case Segment::Text:
+			output.append(file.text, segment.begin, segment.end - segment.begin);
+			break;
+
+		case Segment::Version:
+			// #version only counts in the root, the defines go right after it since nothing may precede it
+			if (depth > 0)
+			{
+				break;
+			}
+			output.append(file.text, segment.begin, segment.end - segment.begin);
+			if (!output.empty() && output.back() != '\n')
+			{
+				output += '\n';
+			}
+			appendDefines(segment.nextLine, fileIndex);
+			break;
+
+		case Segment::Blank:
+			output += '\n';
+			break;
+
+		case Segment::Include:
+		{
+			const std::string& includingPath = context.includeStack.back();
+			if (segment.path.empty())
+			{
+				std::cerr << "ERROR::SHADER_PREPROCESSOR::INCLUDE_NOT_FOUND " << segment.name << " in " << includingPath << ":" << segment.nextLine - 1 << std::endl;
+				return false;
+			}
+			// Checked before the recursion test, #pragma once files may include each other
+			if (std::find(context.includedOnce.begin(), context.includedOnce.end(), segment.path) != context.includedOnce.end())
+			{
+				break;
+			}
+			if (std::find(context.includeStack.begin(), context.includeStack.end(), segment.path) != context.includeStack.end() || depth >= maxIncludeDepth)
+			{
+				std::cerr << "ERROR::SHADER_PREPROCESSOR::RECURSIVE_INCLUDE " << segment.path << " in " << includingPath << std::endl;
+				return false;
+			}
+
+			std::shared_ptr<const ParsedFile> included = GetFile(segment.path);
+			if (!included)
+			{
+				return false;
+			}
+
+			std::vector<std::string>& files = context.result.files;
+			size_t includedIndex = std::find(files.begin(), files.end(), segment.path) - files.begin();
+			if (includedIndex == files.size())
+			{
+				files.push_back(segment.path);
+			}
+			if (included->isIncludedOnce)
+			{
+				context.includedOnce.push_back(segment.path);
+			}
+
+			if (!output.empty() && output.back() != '\n')
+			{
+				output += '\n';
+			}
+			output += "#line 1 " + std::to_string(includedIndex) + "\n";
+
+			context.includeStack.push_back(segment.path);
+			bool isExpanded = Expand(*included, includedIndex, context, depth + 1);
+			context.includeStack.pop_back();
+			if (!isExpanded)
+			{
+				return false;
+			}
+
+			if (!output.empty() && output.back() != '\n')
+			{
+				output += '\n';
+			}
+			output += "#line " + std::to_string(segment.nextLine) + " " + std::to_string(fileIndex) + "\n";
+			break;
+		}
+		}
+	}
+	return true;
+}
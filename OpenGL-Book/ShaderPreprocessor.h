@@ -0,0 +1,87 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+
+struct ShaderDefine
+{
+	std::string name;
+	std::string value;
+};
+
+struct PreprocessedShader
+{
+	std::string source;
+	// Every file the source was expanded from, normalized. Index 0 is the root file and the index
+	// is also the source string number in the #line directives, so "1(12)" in a driver log is line 12 of files[1].
+	std::vector<std::string> files;
+};
+
+// Expands #include "file" (relative to the including file, then the include directories) and #include <file>
+// (include directories only), honours #pragma once, and injects defines right after #version.
+// Parsed files are memoized process wide, so building many variants of the same sources never re-reads a header.
+class ShaderPreprocessor
+{
+public:
+	static void AddIncludeDirectory(const std::string& directory);
+
+	// Reads the root file through the cache
+	static bool Process(const std::string& path, const std::vector<ShaderDefine>& defines, PreprocessedShader& result);
+
+	// The root source is given, path is only used to resolve relative includes and to name the file
+	static bool Process(const std::string& path, std::string_view source, const std::vector<ShaderDefine>& defines, PreprocessedShader& result);
+
+	// Replaces the cached contents of a file that changed on disk, e.g. with the text ShaderWatcher already read
+	static void UpdateFile(const std::string& path, std::string source);
+
+	// Drops a file from the cache so the next use re-reads it
+	static void Invalidate(const std::string& path);
+
+	static void Clear();
+
+	static std::string NormalizePath(const std::string& path);
+
+private:
+	struct Segment
+	{
+		enum Type
+		{
+			Text,
+			Include,
+			Version,
+			Blank		// a directive that is consumed here, stands in for its line to keep the numbering
+		};
+
+		Type type;
+		size_t begin;			// range in the file's text, for Text and Version
+		size_t end;
+		std::string path;		// resolved include, empty if it could not be found
+		std::string name;		// include as written, for errors
+		unsigned int nextLine;	// line number after the directive
+	};
+
+	struct ParsedFile
+	{
+		std::string text;
+		std::vector<Segment> segments;
+		bool isIncludedOnce = false;
+		bool hasVersion = false;
+	};
+
+	struct ExpandContext;
+
+	static std::shared_ptr<const ParsedFile> Parse(const std::string& path, std::string text);
+	static std::shared_ptr<const ParsedFile> GetFile(const std::string& path);
+	static std::string ResolveInclude(const std::string& includingPath, const std::string& name, bool isSystem);
+	static bool Expand(const ParsedFile& file, size_t fileIndex, ExpandContext& context, int depth);
+
+private:
+	static std::mutex s_Mutex;
+	static std::vector<std::string> s_IncludeDirectories;
+	// Normalized path -> parsed file, shared so an expansion can keep using a file another thread just replaced
+	static std::unordered_map<std::string, std::shared_ptr<const ParsedFile>> s_Files;
+};
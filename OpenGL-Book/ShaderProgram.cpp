@@ -1,77 +1,496 @@
 #include <memory>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <fstream>
+#include "Profiler.h"
+#include "ShaderPreprocessor.h"
+#include "ProgramBinaryCache.h"
 #include "ShaderProgram.h"
 
-ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath)
+// From GL_KHR_parallel_shader_compile, glad was generated without extensions
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+bool ShaderProgram::s_HasCompletionStatus = false;
+
+ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath, bool deferred)
+	: ShaderProgram(vertexPath, fragmentPath, std::vector<ShaderDefine>(), deferred)
 {
-	std::string vertexSrc;
-	std::string fragmentSrc;
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
+}
 
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath, std::vector<ShaderDefine> defines, bool deferred)
+	: m_VertexPath(vertexPath), m_FragmentPath(fragmentPath), m_Defines(std::move(defines))
+{
+	PROFILE_FUNCTION();
 
-	try
+	// The root files go through the preprocessor's cache as well, so variants of the same sources are read once
+	PreprocessedShader vertex;
+	PreprocessedShader fragment;
+	if (!ShaderPreprocessor::Process(m_VertexPath, m_Defines, vertex) || !ShaderPreprocessor::Process(m_FragmentPath, m_Defines, fragment))
 	{
-		vShaderFile.open(vertexPath);
-		fShaderFile.open(fragmentPath);
+		m_Status = Status::Failed;
+		return;
+	}
+
+	Build(vertex, fragment, deferred);
+}
+
+ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath, std::string_view vertexSrc, std::string_view fragmentSrc, bool deferred)
+	: m_VertexPath(vertexPath), m_FragmentPath(fragmentPath)
+{
+	PROFILE_FUNCTION();
+
+	Load(vertexSrc, fragmentSrc, deferred);
+}
+
+ShaderProgram::ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath, std::vector<ShaderDefine> defines)
+	: m_VertexPath(vertexPath), m_FragmentPath(fragmentPath), m_Defines(std::move(defines))
+{
+}
+
+std::unique_ptr<ShaderProgram> ShaderProgram::CreateUnloaded(const char* vertexPath, const char* fragmentPath, std::vector<ShaderDefine> defines)
+{
+	return std::unique_ptr<ShaderProgram>(new ShaderProgram(std::string(vertexPath), std::string(fragmentPath), std::move(defines)));
+}
+
+void ShaderProgram::Load(std::string_view vertexSrc, std::string_view fragmentSrc, bool deferred)
+{
+	if (m_Status != Status::Unloaded)
+	{
+		Rebuild(vertexSrc, fragmentSrc);
+		return;
+	}
+
+	PreprocessedShader vertex;
+	PreprocessedShader fragment;
+	if (!ShaderPreprocessor::Process(m_VertexPath, vertexSrc, m_Defines, vertex) || !ShaderPreprocessor::Process(m_FragmentPath, fragmentSrc, m_Defines, fragment))
+	{
+		m_Status = Status::Failed;
+		return;
+	}
+
+	Build(vertex, fragment, deferred);
+}
 
-		if (!fShaderFile.is_open())
+ShaderProgram::~ShaderProgram()
+{
+	for (unsigned int shader : m_PendingShaders)
+	{
+		if (shader)
 		{
-			std::cout << "not open" << std::endl;
+			glDeleteShader(shader);
 		}
+	}
+	GLState::OnProgramDeleted(m_ShaderProgram);
+	glDeleteProgram(m_ShaderProgram);
+}
 
-		std::stringstream vShaderStream;
-		std::stringstream fShaderStream;
+bool ShaderProgram::EnableParallelCompile(GLADloadproc loadProc)
+{
+	int extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
 
-		// Read files buffer into streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
+	const char* extension = nullptr;
+	for (int i = 0; i < extensionCount; i++)
+	{
+		const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+		{
+			extension = "glMaxShaderCompilerThreadsKHR";
+			break;
+		}
+		if (std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)
+		{
+			extension = "glMaxShaderCompilerThreadsARB";
+		}
+	}
 
-		vShaderFile.close();
-		fShaderFile.close();
+	if (!extension)
+	{
+		return false;
+	}
 
-		vertexSrc = vShaderStream.str();
-		fragmentSrc = fShaderStream.str();
+	// glad was generated without extensions so the entry point has to be fetched by hand
+	using MaxShaderCompilerThreadsProc = void (APIENTRYP)(GLuint count);
+	auto maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(loadProc(extension));
+	if (maxShaderCompilerThreads)
+	{
+		// 0xFFFFFFFF lets the driver pick as many threads as it wants
+		maxShaderCompilerThreads(0xFFFFFFFF);
 	}
-	catch (std::ifstream::failure& e)
+
+	s_HasCompletionStatus = true;
+	return true;
+}
+
+void ShaderProgram::Build(const PreprocessedShader& vertex, const PreprocessedShader& fragment, bool deferred)
+{
+	m_SourceFiles[0] = vertex.files;
+	m_SourceFiles[1] = fragment.files;
+
+	// A cached binary skips compiling and linking entirely. The key covers the expanded text, so editing an include misses too.
+	m_CacheKey = ProgramBinaryCache::ComputeKey(vertex.source, fragment.source);
+	m_ShaderProgram = ProgramBinaryCache::Load(m_CacheKey);
+	if (m_ShaderProgram)
 	{
-		std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		m_Status = Status::Linked;
+		BuildUniformTable();
+		return;
 	}
 
-	const char* vertexSrcCStr = vertexSrc.c_str();
-	const char* fragmentSrcCStr = fragmentSrc.c_str();
+	Submit(vertex.source, fragment.source);
+
+	if (!deferred)
+	{
+		Finish();
+	}
+}
+
+bool ShaderProgram::Rebuild(std::string_view vertexSrc, std::string_view fragmentSrc)
+{
+	PreprocessedShader vertex;
+	PreprocessedShader fragment;
+	if (!ShaderPreprocessor::Process(m_VertexPath, vertexSrc, m_Defines, vertex) || !ShaderPreprocessor::Process(m_FragmentPath, fragmentSrc, m_Defines, fragment))
+	{
+		return false;
+	}
+	return Swap(vertex, fragment);
+}
+
+bool ShaderProgram::Reload()
+{
+	return BeginReload() && EndReload();
+}
+
+bool ShaderProgram::BeginReload()
+{
+	PreprocessedShader vertex;
+	PreprocessedShader fragment;
+	if (!ShaderPreprocessor::Process(m_VertexPath, m_Defines, vertex) || !ShaderPreprocessor::Process(m_FragmentPath, m_Defines, fragment))
+	{
+		return false;
+	}
+	SubmitReplacement(vertex, fragment);
+	return true;
+}
+
+bool ShaderProgram::Swap(const PreprocessedShader& vertex, const PreprocessedShader& fragment)
+{
+	SubmitReplacement(vertex, fragment);
+	return EndReload();
+}
+
+void ShaderProgram::SubmitReplacement(const PreprocessedShader& vertex, const PreprocessedShader& fragment)
+{
+	// Still compiling the previous sources, finish those first so this program is never swapped mid compile
+	Finish();
+
+	// Same paths and defines, only the program object and what it was built from move over
+	m_Replacement.reset(new ShaderProgram(m_VertexPath, m_FragmentPath, m_Defines));
+	m_Replacement->Build(vertex, fragment, true);
+}
+
+bool ShaderProgram::EndReload()
+{
+	// Destroying the replacement deletes whichever program object didn't make it,
+	// a typo in the editor shouldn't take the scene down
+	std::unique_ptr<ShaderProgram> replacement = std::move(m_Replacement);
+	if (!replacement || !replacement->Finish())
+	{
+		return false;
+	}
+
+	// GL defers the delete while the old program is still bound
+	std::swap(m_ShaderProgram, replacement->m_ShaderProgram);
+	std::swap(m_SourceFiles, replacement->m_SourceFiles);
+	m_CacheKey = replacement->m_CacheKey;
+	m_Status = Status::Linked;
+	BuildUniformTable();
+	return true;
+}
+
+std::vector<std::string> ShaderProgram::GetDependencies() const
+{
+	std::vector<std::string> dependencies = m_SourceFiles[0];
+	for (const std::string& file : m_SourceFiles[1])
+	{
+		if (std::find(dependencies.begin(), dependencies.end(), file) == dependencies.end())
+		{
+			dependencies.push_back(file);
+		}
+	}
+	return dependencies;
+}
+
+bool ShaderProgram::DependsOn(const std::string& path) const
+{
+	for (const std::vector<std::string>& files : m_SourceFiles)
+	{
+		if (std::find(files.begin(), files.end(), path) != files.end())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ShaderProgram::Submit(std::string_view vertexSrc, std::string_view fragmentSrc)
+{
+	// Nothing in here queries a status, so the driver is free to compile in the background until Finish()
+	// The sources aren't null terminated, pass the lengths explicitly
+	const char* vertexSrcPtr = vertexSrc.data();
+	const char* fragmentSrcPtr = fragmentSrc.data();
+	int vertexSrcLength = static_cast<int>(vertexSrc.size());
+	int fragmentSrcLength = static_cast<int>(fragmentSrc.size());
 
 	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexSrcCStr, nullptr);
+	glShaderSource(vertexShader, 1, &vertexSrcPtr, &vertexSrcLength);
 	glCompileShader(vertexShader);
-	CheckErrors(vertexShader, "VERTEX");
 
 	unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentSrcCStr, nullptr);
+	glShaderSource(fragmentShader, 1, &fragmentSrcPtr, &fragmentSrcLength);
 	glCompileShader(fragmentShader);
-	CheckErrors(fragmentShader, "FRAGMENT");
 
 	m_ShaderProgram = glCreateProgram();
 	glAttachShader(m_ShaderProgram, vertexShader);
 	glAttachShader(m_ShaderProgram, fragmentShader);
+	if (ProgramBinaryCache::IsSupported())
+	{
+		glProgramParameteri(m_ShaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(m_ShaderProgram);
-	CheckErrors(m_ShaderProgram, "PROGRAM");
 
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	m_PendingShaders[0] = vertexShader;
+	m_PendingShaders[1] = fragmentShader;
+	m_Status = Status::Compiling;
+}
+
+bool ShaderProgram::IsReady() const
+{
+	if (m_Status != Status::Compiling)
+	{
+		return m_Status != Status::Unloaded;
+	}
+
+	// Without the extension there is no way to ask without blocking, Finish() will stall instead
+	if (!s_HasCompletionStatus)
+	{
+		return true;
+	}
+
+	int isComplete = 0;
+	glGetProgramiv(m_ShaderProgram, GL_COMPLETION_STATUS_KHR, &isComplete);
+	return isComplete;
+}
+
+bool ShaderProgram::Finish()
+{
+	PROFILE_FUNCTION();
+
+	if (m_Status != Status::Compiling)
+	{
+		return m_Status == Status::Linked;
+	}
+
+	// Only dig into the individual shaders when linking failed, their logs say why
+	bool isLinked = CheckErrors(m_ShaderProgram, "PROGRAM");
+	if (!isLinked)
+	{
+		CheckErrors(m_PendingShaders[0], "VERTEX");
+		CheckErrors(m_PendingShaders[1], "FRAGMENT");
+
+		// Driver logs name files by their source string number, see PreprocessedShader
+		const char* stages[2] = { "VERTEX", "FRAGMENT" };
+		for (int stage = 0; stage < 2; stage++)
+		{
+			for (size_t i = 1; i < m_SourceFiles[stage].size(); i++)
+			{
+				std::cerr << stages[stage] << " source string " << i << " = " << m_SourceFiles[stage][i] << std::endl;
+			}
+		}
+	}
+
+	for (unsigned int& shader : m_PendingShaders)
+	{
+		glDetachShader(m_ShaderProgram, shader);
+		glDeleteShader(shader);
+		shader = 0;
+	}
+
+	if (!isLinked)
+	{
+		m_Status = Status::Failed;
+		return false;
+	}
+
+	ProgramBinaryCache::Store(m_ShaderProgram, m_CacheKey);
+	BuildUniformTable();
+	m_Status = Status::Linked;
+	return true;
+}
+
+UniformHandle ShaderProgram::GetUniformHandle(const char* name) const
+{
+	// Resolved once and kept, so the name is always compared: a hash collision must not hand out another uniform's slot
+	auto it = m_UniformSlots.find(HashString(name));
+	if (it == m_UniformSlots.end() || m_UniformNames[it->second] != name)
+	{
+		return UniformHandle();
+	}
+	return UniformHandle{ it->second };
 }
 
-void ShaderProgram::CheckErrors(unsigned int shader, const char* type) const
+void ShaderProgram::BuildUniformTable()
+{
+	// Slots survive a rebuild so handles resolved before a hot reload keep pointing at the same uniform,
+	// uniforms that were optimized out of the new program just go back to location -1
+	if (m_UniformLocations.empty())
+	{
+		m_UniformLocations.push_back(-1);
+		m_UniformNames.emplace_back();
+	}
+	std::fill(m_UniformLocations.begin() + 1, m_UniformLocations.end(), -1);
+
+	m_Reflection = ShaderReflection::Reflect(m_ShaderProgram);
+	for (const ShaderVariable& uniform : m_Reflection.GetUniforms())
+	{
+		// Members of uniform blocks have no location
+		if (uniform.location < 0)
+		{
+			continue;
+		}
+
+		std::string name(m_Reflection.GetName(uniform));
+		AddUniform(name, uniform.location);
+
+		// Arrays are registered under the bare name, also register "name[0]" and every other element
+		if (uniform.arraySize > 1)
+		{
+			AddUniform(name + "[0]", uniform.location);
+			for (int element = 1; element < uniform.arraySize; element++)
+			{
+				std::string elementName = name + "[" + std::to_string(element) + "]";
+				AddUniform(elementName, glGetUniformLocation(m_ShaderProgram, elementName.c_str()));
+			}
+		}
+	}
+
+	for (const auto& [name, binding] : m_UniformBlockBindings)
+	{
+		if (const UniformBlockLayout* block = GetUniformBlock(name.c_str()))
+		{
+			glUniformBlockBinding(m_ShaderProgram, block->GetIndex(), binding);
+		}
+	}
+	for (const auto& [name, unit] : m_SamplerUnits)
+	{
+		ApplySamplerUnit(name, unit);
+	}
+}
+
+void ShaderProgram::AddUniform(const std::string& name, int location)
+{
+	uint32_t hash = HashString(name.c_str(), name.size());
+	auto it = m_UniformSlots.find(hash);
+	if (it != m_UniformSlots.end())
+	{
+		if (m_UniformNames[it->second] != name)
+		{
+			std::cerr << "ERROR::SHADER::UNIFORM_HASH_COLLISION " << name << std::endl;
+			return;
+		}
+		m_UniformLocations[it->second] = location;
+		return;
+	}
+
+	m_UniformSlots[hash] = static_cast<unsigned int>(m_UniformLocations.size());
+	m_UniformLocations.push_back(location);
+	m_UniformNames.push_back(name);
+}
+
+void ShaderProgram::ReportHashCollision(const char* name, unsigned int slot) const
+{
+	std::cerr << "ERROR::SHADER::UNIFORM_HASH_COLLISION " << name << " hashes like " << m_UniformNames[slot] << std::endl;
+}
+
+void ShaderProgram::CheckUniformType(uint32_t hash, GLenum type, const char* name) const
+{
+	// Element names like "lights[2]" aren't in the reflection, only the array itself
+	const ShaderVariable* uniform = m_Reflection.FindUniform(hash);
+	if (uniform && !IsUniformTypeCompatible(type, uniform->type))
+	{
+		std::cerr << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH " << name << std::endl;
+	}
+}
+
+void ShaderProgram::SetUniformBlockBinding(const char* blockName, unsigned int binding)
+{
+	auto it = std::find_if(m_UniformBlockBindings.begin(), m_UniformBlockBindings.end(), [blockName](const auto& entry)
+	{
+		return entry.first == blockName;
+	});
+	if (it != m_UniformBlockBindings.end())
+	{
+		it->second = binding;
+	}
+	else
+	{
+		m_UniformBlockBindings.emplace_back(blockName, binding);
+	}
+
+	if (const UniformBlockLayout* block = GetUniformBlock(blockName))
+	{
+		glUniformBlockBinding(m_ShaderProgram, block->GetIndex(), binding);
+	}
+}
+
+void ShaderProgram::SetSamplerUnit(const char* samplerName, int unit)
+{
+	auto it = std::find_if(m_SamplerUnits.begin(), m_SamplerUnits.end(), [samplerName](const auto& entry)
+	{
+		return entry.first == samplerName;
+	});
+	if (it != m_SamplerUnits.end())
+	{
+		it->second = unit;
+	}
+	else
+	{
+		m_SamplerUnits.emplace_back(samplerName, unit);
+	}
+
+	if (IsLinked())
+	{
+		ApplySamplerUnit(samplerName, unit);
+	}
+}
+
+void ShaderProgram::ApplySamplerUnit(const std::string& samplerName, int unit) const
+{
+	int location = FindUniformLocation(HashString(samplerName.c_str(), samplerName.size()), samplerName.c_str());
+	if (location < 0)
+	{
+		return;
+	}
+	if (GLAD_GL_VERSION_4_1)
+	{
+		glProgramUniform1i(m_ShaderProgram, location, unit);
+	}
+	else
+	{
+		GLState::UseProgram(m_ShaderProgram);
+		glUniform1i(location, unit);
+	}
+}
+
+bool ShaderProgram::CheckErrors(unsigned int shader, const char* type) const
 {
 	constexpr size_t bufferSize = 1024;
 	int success;
 	char infoLog[bufferSize];
 
-	if (type != "PROGRAM")
+	if (std::strcmp(type, "PROGRAM") != 0)
 	{
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 		if (!success)
@@ -89,4 +508,6 @@ void ShaderProgram::CheckErrors(unsigned int shader, const char* type) const
 			std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << std::endl;
 		}
 	}
+
+	return success;
 }
@@ -1,42 +1,299 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
 #include <glad/glad.h>
+#include "Hash.h"
+#include "GLState.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+#include "Uniform.h"
+
+// Index into a program's uniform location table. Resolve once with GetUniformHandle() and reuse it every frame.
+// The default handle points at slot 0 which always holds location -1, so setting an unresolved handle is a no-op.
+struct UniformHandle
+{
+	unsigned int index = 0;
+
+	bool IsValid() const { return index != 0; }
+};
 
 class ShaderProgram
 {
 public:
-	ShaderProgram(const char* vertexPath, const char* fragmentPath);
+	// A deferred program only submits its sources, poll IsReady() and call Finish() before using it
+	ShaderProgram(const char* vertexPath, const char* fragmentPath, bool deferred = false);
+
+	// The defines are injected after #version, see ShaderPreprocessor
+	ShaderProgram(const char* vertexPath, const char* fragmentPath, std::vector<ShaderDefine> defines, bool deferred = false);
+
+	// Sources that were already read, e.g. by a ShaderSourceLoader. The paths are kept for hot reloading.
+	ShaderProgram(const char* vertexPath, const char* fragmentPath, std::string_view vertexSrc, std::string_view fragmentSrc, bool deferred = false);
+
+	// Only records the paths, nothing is compiled until the sources are handed over with Load()
+	static std::unique_ptr<ShaderProgram> CreateUnloaded(const char* vertexPath, const char* fragmentPath, std::vector<ShaderDefine> defines = {});
+
+	~ShaderProgram();
+
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+	// Turns on GL_KHR_parallel_shader_compile (or the ARB version) if the driver has it
+	// so IsReady() can poll GL_COMPLETION_STATUS_KHR instead of stalling
+	static bool EnableParallelCompile(GLADloadproc loadProc);
+
+	static bool HasParallelCompile()
+	{
+		return s_HasCompletionStatus;
+	}
+
+	// Submits the sources of a program made with CreateUnloaded()
+	void Load(std::string_view vertexSrc, std::string_view fragmentSrc, bool deferred = false);
+
+	bool IsLoaded() const
+	{
+		return m_Status != Status::Unloaded;
+	}
+
+	// Never blocks when parallel compile is enabled, false until the sources are loaded
+	bool IsReady() const;
+
+	// Checks the link status (blocking if the driver is not done yet) and builds the uniform table
+	bool Finish();
+
+	bool IsLinked() const
+	{
+		return m_Status == Status::Linked;
+	}
+
+	// Compiles and links a new program object from the given sources and swaps it in only if linking succeeds.
+	// Uniform handles stay valid, uniform values have to be set again.
+	bool Rebuild(std::string_view vertexSrc, std::string_view fragmentSrc);
+
+	// Like Rebuild() but with the sources and includes taken from the preprocessor's cache, see ShaderPreprocessor::UpdateFile()
+	bool Reload();
+
+	// Reload() without the stall: the new program is only submitted, the current one keeps running until
+	// EndReload() swaps it in. Poll IsReloadReady() on later frames first. A second BeginReload() replaces the pending one.
+	bool BeginReload();
+
+	bool IsReloading() const
+	{
+		return m_Replacement != nullptr;
+	}
+
+	bool IsReloadReady() const
+	{
+		return m_Replacement && m_Replacement->IsReady();
+	}
+
+	// Returns true if the new program linked and replaced the current one, otherwise the current one stays
+	bool EndReload();
+
+	// Every file the program was built from, includes as well, normalized
+	std::vector<std::string> GetDependencies() const;
+	bool DependsOn(const std::string& path) const;
+
+	const std::vector<ShaderDefine>& GetDefines() const
+	{
+		return m_Defines;
+	}
+
+	const std::string& GetVertexPath() const
+	{
+		return m_VertexPath;
+	}
+
+	const std::string& GetFragmentPath() const
+	{
+		return m_FragmentPath;
+	}
 
 	void Use() const
 	{
-		glUseProgram(m_ShaderProgram);
+		GLState::UseProgram(m_ShaderProgram);
+	}
+
+	UniformHandle GetUniformHandle(const char* name) const;
+
+	UniformHandle GetUniformHandle(const std::string& name) const
+	{
+		return GetUniformHandle(name.c_str());
+	}
+
+	int GetUniformLocation(UniformHandle handle) const
+	{
+		return m_UniformLocations[handle.index];
+	}
+
+	// Uniforms the compiler optimized out have location -1, those are skipped without calling into GL
+
+	void SetInt(UniformHandle handle, int value) const
+	{
+		int location = m_UniformLocations[handle.index];
+		if (location >= 0)
+		{
+			glUniform1i(location, value);
+		}
 	}
 
 	void SetInt(const std::string& name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_ShaderProgram, name.c_str()), value);
+		SetInt(GetUniformHandle(name), value);
 	}
 
-	// This will be faster if a literal is passed
-	void SetInt(const const char* name, int value) const
+	void SetInt(const char* name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_ShaderProgram, name), value);
+		SetInt(GetUniformHandle(name), value);
+	}
+
+	void SetFloat(UniformHandle handle, float value) const
+	{
+		int location = m_UniformLocations[handle.index];
+		if (location >= 0)
+		{
+			glUniform1f(location, value);
+		}
 	}
 
 	void SetFloat(const std::string& name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_ShaderProgram, name.c_str()), value);
+		SetFloat(GetUniformHandle(name), value);
 	}
 
 	void SetFloat(const char* name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_ShaderProgram, name), value);
+		SetFloat(GetUniformHandle(name), value);
+	}
+
+	// Typed setter, the name was hashed at compile time so this is one table lookup and one GL call.
+	// With GL 4.1 it goes through glProgramUniform* and the program doesn't have to be in use.
+	template<typename T>
+	void Set(const Uniform<T>& uniform, const T& value) const
+	{
+		Set(uniform, &value, 1);
+	}
+
+	// Sets count consecutive elements of an array uniform, starting at the element the uniform names
+	template<typename T>
+	void Set(const Uniform<T>& uniform, const T* values, int count) const
+	{
+		int location = FindUniformLocation(uniform.GetHash(), uniform.GetName());
+		if (location < 0)
+		{
+			return;
+		}
+#ifndef NDEBUG
+		CheckUniformType(uniform.GetHash(), UniformTraits<T>::type, uniform.GetName());
+#endif
+		if (GLAD_GL_VERSION_4_1)
+		{
+			UniformTraits<T>::Set(m_ShaderProgram, location, count, values);
+		}
+		else
+		{
+			UniformTraits<T>::Set(location, count, values);
+		}
+	}
+
+	// Remembered and applied again after every (re)link, GLSL 330 has no layout(binding = N)
+	void SetUniformBlockBinding(const char* blockName, unsigned int binding);
+
+	// Same for samplers: the texture unit the sampler reads, what Texture::Bind(unit) binds to
+	void SetSamplerUnit(const char* samplerName, int unit);
+
+	// Layout of an active uniform block, nullptr if the program has no such block or the compiler removed it
+	const UniformBlockLayout* GetUniformBlock(const char* name) const
+	{
+		return m_Reflection.FindUniformBlock(name);
+	}
+
+	// Attributes, uniforms and blocks of the linked program, replaced as a whole on every (re)link
+	const ShaderReflection& GetReflection() const
+	{
+		return m_Reflection;
 	}
 
 private:
-	void CheckErrors(unsigned int shader, const char* type) const;
+	// Returns true if the shader compiled / the program linked
+	bool CheckErrors(unsigned int shader, const char* type) const;
+
+	// Reflects the program once after linking so the setters never have to ask the driver for a location,
+	// also applies the uniform block bindings
+	void BuildUniformTable();
+	void AddUniform(const std::string& name, int location);
+	void ApplySamplerUnit(const std::string& samplerName, int unit) const;
+
+	// The hash alone picks the slot, debug builds also compare the name so a name the program doesn't declare
+	// can't silently set another uniform whose hash it collides with
+	int FindUniformLocation(uint32_t hash, const char* name) const
+	{
+		auto it = m_UniformSlots.find(hash);
+		if (it == m_UniformSlots.end())
+		{
+			return -1;
+		}
+#ifndef NDEBUG
+		if (m_UniformNames[it->second] != name)
+		{
+			ReportHashCollision(name, it->second);
+			return -1;
+		}
+#endif
+		return m_UniformLocations[it->second];
+	}
+
+	void ReportHashCollision(const char* name, unsigned int slot) const;
+
+	// Prints an error if the program declares the uniform with a type T can't be set to
+	void CheckUniformType(uint32_t hash, GLenum type, const char* name) const;
+
+	// Used by CreateUnloaded()
+	ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath, std::vector<ShaderDefine> defines);
+
+	void Build(const PreprocessedShader& vertex, const PreprocessedShader& fragment, bool deferred);
+	// Builds a new program object and only replaces the current one if it links
+	bool Swap(const PreprocessedShader& vertex, const PreprocessedShader& fragment);
+	// Starts building the program Swap() / EndReload() put in place
+	void SubmitReplacement(const PreprocessedShader& vertex, const PreprocessedShader& fragment);
+	void Submit(std::string_view vertexSrc, std::string_view fragmentSrc);
 
 private:
-	unsigned int m_ShaderProgram;
+	enum class Status
+	{
+		Unloaded,
+		Compiling,
+		Linked,
+		Failed
+	};
+
+	std::string m_VertexPath;
+	std::string m_FragmentPath;
+	std::vector<ShaderDefine> m_Defines;
+	// Vertex and fragment file tables, index 0 is the root file
+	std::vector<std::string> m_SourceFiles[2];
+
+	unsigned int m_ShaderProgram = 0;
+	Status m_Status = Status::Unloaded;
+	unsigned int m_PendingShaders[2] = {};
+	uint64_t m_CacheKey = 0;
+
+	static bool s_HasCompletionStatus;
+
+	// Flat location table, slot 0 is reserved for "not found"
+	std::vector<int> m_UniformLocations;
+	// Name of every slot, same indices as m_UniformLocations
+	std::vector<std::string> m_UniformNames;
+	// Name hash -> slot in m_UniformLocations
+	std::unordered_map<uint32_t, unsigned int> m_UniformSlots;
+
+	// Built from newer sources while this one is still in use, see BeginReload()
+	std::unique_ptr<ShaderProgram> m_Replacement;
+
+	ShaderReflection m_Reflection;
+	std::vector<std::pair<std::string, unsigned int>> m_UniformBlockBindings;
+	std::vector<std::pair<std::string, int>> m_SamplerUnits;
 };
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <algorithm>
+#include "ShaderReflection.h"
+
+namespace
+{
+	// Arrays are reported as "name[0]", struct arrays as "name[0].member" which has to stay as is
+	std::string StripArraySuffix(std::string name)
+	{
+		size_t bracket = name.find('[');
+		if (bracket != std::string::npos && name.find('.', bracket) == std::string::npos)
+		{
+			name.resize(bracket);
+		}
+		return name;
+	}
+
+	// VertexFormat only ever calls glVertexAttribPointer, integer inputs need glVertexAttribIPointer
+	bool IsFloatInput(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+		case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+			return false;
+		default:
+			return true;
+		}
+	}
+}
+
+ShaderReflection ShaderReflection::Reflect(unsigned int program)
+{
+	ShaderReflection reflection;
+
+	int attributeCount = 0;
+	int maxAttributeLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxAttributeLength);
+
+	std::vector<char> nameBuffer(maxAttributeLength > 0 ? maxAttributeLength : 1);
+	for (int i = 0; i < attributeCount; i++)
+	{
+		int length = 0;
+		int size = 0;
+		GLenum type;
+		glGetActiveAttrib(program, i, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+		std::string name(nameBuffer.data(), length);
+
+		// Built-ins like gl_VertexID are listed too but have no location
+		int location = glGetAttribLocation(program, name.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+		reflection.AddVariable(reflection.m_Attributes, StripArraySuffix(std::move(name)), { 0, type, location, size, -1, -1, 0, 0 });
+	}
+
+	int uniformCount = 0;
+	int maxUniformLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformLength);
+
+	if (uniformCount > 0)
+	{
+		// Block index and offset for all uniforms in one query each
+		std::vector<GLuint> indices(uniformCount);
+		for (int i = 0; i < uniformCount; i++)
+		{
+			indices[i] = i;
+		}
+		std::vector<int> blockIndices(uniformCount), offsets(uniformCount);
+		glGetActiveUniformsiv(program, uniformCount, indices.data(), GL_UNIFORM_BLOCK_INDEX, blockIndices.data());
+		glGetActiveUniformsiv(program, uniformCount, indices.data(), GL_UNIFORM_OFFSET, offsets.data());
+
+		nameBuffer.assign(maxUniformLength > 0 ? maxUniformLength : 1, 0);
+		for (int i = 0; i < uniformCount; i++)
+		{
+			int length = 0;
+			int size = 0;
+			GLenum type;
+			glGetActiveUniform(program, i, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+			std::string name(nameBuffer.data(), length);
+
+			ShaderVariable uniform = { 0, type, -1, size, blockIndices[i], -1, 0, 0 };
+			if (uniform.blockIndex >= 0)
+			{
+				uniform.blockOffset = offsets[i];
+			}
+			else
+			{
+				uniform.location = glGetUniformLocation(program, name.c_str());
+			}
+			reflection.AddVariable(reflection.m_Uniforms, StripArraySuffix(std::move(name)), uniform);
+		}
+	}
+
+	int blockCount = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+	for (int i = 0; i < blockCount; i++)
+	{
+		reflection.m_UniformBlocks.push_back(UniformBlockLayout::Reflect(program, i));
+	}
+
+	reflection.m_Names.shrink_to_fit();
+	return reflection;
+}
+
+void ShaderReflection::AddVariable(std::vector<ShaderVariable>& table, std::string name, ShaderVariable variable)
+{
+	variable.hash = HashString(name.c_str(), name.size());
+	if (Find(table, variable.hash))
+	{
+		std::cerr << "ERROR::SHADER_REFLECTION::HASH_COLLISION " << name << std::endl;
+		return;
+	}
+
+	variable.nameOffset = static_cast<uint32_t>(m_Names.size());
+	variable.nameLength = static_cast<uint32_t>(name.size());
+	m_Names += name;
+
+	// Kept sorted as it grows so Find() works during Reflect() as well
+	auto it = std::lower_bound(table.begin(), table.end(), variable.hash, [](const ShaderVariable& entry, uint32_t hash)
+	{
+		return entry.hash < hash;
+	});
+	table.insert(it, variable);
+}
+
+const ShaderVariable* ShaderReflection::Find(const std::vector<ShaderVariable>& table, uint32_t hash)
+{
+	auto it = std::lower_bound(table.begin(), table.end(), hash, [](const ShaderVariable& entry, uint32_t value)
+	{
+		return entry.hash < value;
+	});
+	if (it == table.end() || it->hash != hash)
+	{
+		return nullptr;
+	}
+	return &*it;
+}
+
+const UniformBlockLayout* ShaderReflection::FindUniformBlock(const char* name) const
+{
+	for (const UniformBlockLayout& block : m_UniformBlocks)
+	{
+		if (block.GetName() == name)
+		{
+			return &block;
+		}
+	}
+	return nullptr;
+}
+
+int ShaderReflection::GetLocationCount(GLenum type)
+{
+	switch (type)
+	{
+	case GL_FLOAT_MAT2: case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: return 2;
+	case GL_FLOAT_MAT3: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4: return 3;
+	case GL_FLOAT_MAT4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3: return 4;
+	default: return 1;
+	}
+}
+
+bool ShaderReflection::CheckVertexFormat(const VertexFormat& format, uint32_t otherLocations) const
+{
+	uint32_t formatLocations = 0;
+	for (const VertexAttribute& attribute : format.GetAttributes())
+	{
+		if (attribute.location < 32)
+		{
+			formatLocations |= 1u << attribute.location;
+		}
+	}
+
+	bool isValid = true;
+	for (const ShaderVariable& attribute : m_Attributes)
+	{
+		int locationCount = GetLocationCount(attribute.type) * attribute.arraySize;
+		for (int i = 0; i < locationCount; i++)
+		{
+			int location = attribute.location + i;
+			if (location >= 32 || (otherLocations & (1u << location)))
+			{
+				continue;
+			}
+			if (!(formatLocations & (1u << location)))
+			{
+				std::cerr << "ERROR::SHADER_REFLECTION::MISSING_ATTRIBUTE " << GetName(attribute) << " location " << location << std::endl;
+				isValid = false;
+			}
+			else if (!IsFloatInput(attribute.type))
+			{
+				std::cerr << "ERROR::SHADER_REFLECTION::INTEGER_ATTRIBUTE " << GetName(attribute) << " is fed floats" << std::endl;
+				isValid = false;
+			}
+		}
+	}
+	return isValid;
+}
+
+VertexFormat ShaderReflection::BindVertexFormat(const VertexFormat& format, const std::vector<const char*>& names) const
+{
+	VertexFormat bound = format;
+	for (size_t i = 0; i < format.GetAttributes().size() && i < names.size(); i++)
+	{
+		const ShaderVariable* attribute = FindAttribute(names[i]);
+		bound.SetLocation(i, attribute ? static_cast<unsigned int>(attribute->location) : VertexFormat::unusedLocation);
+	}
+	return bound;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <glad/glad.h>
+#include "Hash.h"
+#include "UniformBlock.h"
+#include "VertexFormat.h"
+
+// One active attribute or uniform. Arrays are stored once under their bare name with arraySize > 1.
+struct ShaderVariable
+{
+	uint32_t hash;			// HashString of the name
+	GLenum type;			// GL_FLOAT_VEC3, GL_SAMPLER_2D, ...
+	int location;			// -1 for uniform block members
+	int arraySize;			// 1 for non arrays
+	int blockIndex;			// uniforms only, -1 outside of a block
+	int blockOffset;		// byte offset inside the block, -1 outside of a block
+	uint32_t nameOffset;	// into the shared name pool, see ShaderReflection::GetName()
+	uint32_t nameLength;
+};
+
+// Everything a linked program consumes, queried once after link and never changed afterwards.
+// Lookups are a binary search over tables sorted by name hash, the names themselves live in one pool.
+class ShaderReflection
+{
+public:
+	ShaderReflection() = default;
+
+	static ShaderReflection Reflect(unsigned int program);
+
+	const ShaderVariable* FindAttribute(uint32_t hash) const
+	{
+		return Find(m_Attributes, hash);
+	}
+
+	const ShaderVariable* FindAttribute(const char* name) const
+	{
+		return Find(m_Attributes, HashString(name));
+	}
+
+	const ShaderVariable* FindUniform(uint32_t hash) const
+	{
+		return Find(m_Uniforms, hash);
+	}
+
+	const ShaderVariable* FindUniform(const char* name) const
+	{
+		return Find(m_Uniforms, HashString(name));
+	}
+
+	// False for uniforms the compiler optimized out, setting those is wasted work
+	bool HasUniform(const char* name) const
+	{
+		return FindUniform(name) != nullptr;
+	}
+
+	const UniformBlockLayout* FindUniformBlock(const char* name) const;
+
+	std::string_view GetName(const ShaderVariable& variable) const
+	{
+		return std::string_view(m_Names).substr(variable.nameOffset, variable.nameLength);
+	}
+
+	const std::vector<ShaderVariable>& GetAttributes() const
+	{
+		return m_Attributes;
+	}
+
+	const std::vector<ShaderVariable>& GetUniforms() const
+	{
+		return m_Uniforms;
+	}
+
+	const std::vector<UniformBlockLayout>& GetUniformBlocks() const
+	{
+		return m_UniformBlocks;
+	}
+
+	// Prints every attribute the program reads that the format doesn't feed, or feeds as floats to an integer input.
+	// otherLocations is a bit mask of locations that come from elsewhere, e.g. an InstanceBuffer.
+	bool CheckVertexFormat(const VertexFormat& format, uint32_t otherLocations = 0) const;
+
+	// Copy of the format with every attribute moved to the location the linker gave the input of the same name,
+	// names[i] belongs to format.GetAttributes()[i]. Inputs the program doesn't read keep their bytes but aren't applied.
+	VertexFormat BindVertexFormat(const VertexFormat& format, const std::vector<const char*>& names) const;
+
+	// Number of consecutive locations an attribute of this type takes, mat4 takes 4
+	static int GetLocationCount(GLenum type);
+
+private:
+	static const ShaderVariable* Find(const std::vector<ShaderVariable>& table, uint32_t hash);
+
+	void AddVariable(std::vector<ShaderVariable>& table, std::string name, ShaderVariable variable);
+
+private:
+	std::vector<ShaderVariable> m_Attributes;
+	std::vector<ShaderVariable> m_Uniforms;
+	std::vector<UniformBlockLayout> m_UniformBlocks;
+	std::string m_Names;
+};
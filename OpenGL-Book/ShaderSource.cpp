@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <iostream>
+#include "Profiler.h"
+#include "ShaderSource.h"
+
+bool ShaderSource::Load(const char* path)
+{
+	PROFILE_FUNCTION();
+
+	m_Data.reset();
+	m_Length = 0;
+
+	std::FILE* file = std::fopen(path, "rb");
+	if (!file)
+	{
+		std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+		return false;
+	}
+
+	// Size the buffer once and fill it with a single read, no stream buffers and no intermediate copies
+	long length = -1;
+	if (std::fseek(file, 0, SEEK_END) == 0)
+	{
+		length = std::ftell(file);
+		std::fseek(file, 0, SEEK_SET);
+	}
+
+	bool isRead = length >= 0;
+	if (isRead && length > 0)
+	{
+		m_Data.reset(new char[length]);
+		isRead = std::fread(m_Data.get(), 1, length, file) == static_cast<size_t>(length);
+	}
+	std::fclose(file);
+
+	if (!isRead)
+	{
+		std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+		m_Data.reset();
+		return false;
+	}
+
+	m_Length = static_cast<size_t>(length);
+	return true;
+}
+
+ShaderSourceLoader::ShaderSourceLoader()
+	: m_Thread(&ShaderSourceLoader::ThreadMain, this)
+{
+}
+
+ShaderSourceLoader::~ShaderSourceLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsRunning = false;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+}
+
+size_t ShaderSourceLoader::Request(const std::string& path)
+{
+	size_t index;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		index = m_Requests.size();
+		m_Requests.emplace_back();
+		m_Requests.back().path = path;
+	}
+	m_Condition.notify_all();
+	return index;
+}
+
+bool ShaderSourceLoader::IsLoaded(size_t index) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Requests[index].isLoaded.load(std::memory_order_acquire);
+}
+
+void ShaderSourceLoader::Wait(size_t index)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this, index]()
+	{
+		return m_Requests[index].isLoaded.load(std::memory_order_acquire);
+	});
+}
+
+std::string_view ShaderSourceLoader::Get(size_t index) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Requests[index].source.GetText();
+}
+
+void ShaderSourceLoader::ThreadMain()
+{
+	Profiler::SetThreadName("Shader Loader");
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_Condition.wait(lock, [this]()
+		{
+			return !m_IsRunning || m_NextRequest < m_Requests.size();
+		});
+		if (!m_IsRunning)
+		{
+			return;
+		}
+
+		// Growing a deque at the back never moves existing elements, so the request can be filled in without the lock
+		PendingFile& request = m_Requests[m_NextRequest++];
+		lock.unlock();
+		request.source.Load(request.path.c_str());
+		request.isLoaded.store(true, std::memory_order_release);
+		lock.lock();
+
+		m_Condition.notify_all();
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <string_view>
+#include <condition_variable>
+
+// A shader source file read with one sized read into one exactly sized buffer.
+// The text is not null terminated, hand it to glShaderSource with its length.
+class ShaderSource
+{
+public:
+	bool Load(const char* path);
+
+	std::string_view GetText() const
+	{
+		return std::string_view(m_Data.get(), m_Length);
+	}
+
+private:
+	std::unique_ptr<char[]> m_Data;
+	size_t m_Length = 0;
+};
+
+// Reads shader sources on a worker thread in request order, so a startup with hundreds of files
+// doesn't spend its first frames in fopen/fread on the GL thread
+class ShaderSourceLoader
+{
+public:
+	ShaderSourceLoader();
+	~ShaderSourceLoader();
+
+	ShaderSourceLoader(const ShaderSourceLoader&) = delete;
+	ShaderSourceLoader& operator=(const ShaderSourceLoader&) = delete;
+
+	// Returns the index to poll with IsLoaded() / Get()
+	size_t Request(const std::string& path);
+
+	// True once the file was read, or failed to be
+	bool IsLoaded(size_t index) const;
+
+	void Wait(size_t index);
+
+	// Empty if the file could not be read. Only valid once IsLoaded() returned true.
+	std::string_view Get(size_t index) const;
+
+private:
+	struct PendingFile
+	{
+		std::string path;
+		ShaderSource source;
+		std::atomic<bool> isLoaded = false;
+	};
+
+	void ThreadMain();
+
+private:
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	// A deque keeps the requests in place while the worker fills them in
+	std::deque<PendingFile> m_Requests;
+	size_t m_NextRequest = 0;
+
+	bool m_IsRunning = true;
+	std::thread m_Thread;
+};
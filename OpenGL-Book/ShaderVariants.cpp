@@ -0,0 +1,172 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "Profiler.h"
+#include "ShaderVariants.h"
+
+ShaderVariants::ShaderVariants(const char* vertexPath, const char* fragmentPath)
+	: m_VertexPath(vertexPath), m_FragmentPath(fragmentPath)
+{
+}
+
+ShaderKeyword ShaderVariants::AddToggle(const char* name)
+{
+	return AddKeyword({ name }, 1);
+}
+
+ShaderKeyword ShaderVariants::AddEnum(std::vector<std::string> values)
+{
+	// A single value would get no bits, and GetDefines() would take it for a toggle that is never set
+	if (values.size() < 2)
+	{
+		std::cerr << "ERROR::SHADER_VARIANTS::ENUM_NEEDS_TWO_VALUES " << (values.empty() ? "" : values.front()) << std::endl;
+		return ShaderKeyword();
+	}
+
+	unsigned int bitCount = 0;
+	while ((1u << bitCount) < values.size())
+	{
+		bitCount++;
+	}
+	return AddKeyword(std::move(values), bitCount);
+}
+
+ShaderKeyword ShaderVariants::AddKeyword(std::vector<std::string> names, unsigned int bitCount)
+{
+	if (!m_Variants.empty() || m_KeyBits + bitCount > maxKeyBits)
+	{
+		std::cerr << "ERROR::SHADER_VARIANTS::CANNOT_ADD_KEYWORD " << names.front() << std::endl;
+		return ShaderKeyword();
+	}
+
+	Keyword keyword;
+	keyword.bits.shift = m_KeyBits;
+	keyword.bits.mask = (1u << bitCount) - 1;
+	keyword.names = std::move(names);
+	m_Keywords.push_back(std::move(keyword));
+	m_KeyBits += bitCount;
+	return m_Keywords.back().bits;
+}
+
+std::vector<ShaderDefine> ShaderVariants::GetDefines(uint32_t key) const
+{
+	std::vector<ShaderDefine> defines;
+	for (const Keyword& keyword : m_Keywords)
+	{
+		uint32_t value = (key >> keyword.bits.shift) & keyword.bits.mask;
+		if (keyword.names.size() == 1)
+		{
+			if (value)
+			{
+				defines.push_back({ keyword.names[0], "1" });
+			}
+		}
+		else if (value < keyword.names.size())
+		{
+			defines.push_back({ keyword.names[value], "1" });
+		}
+	}
+	return defines;
+}
+
+ShaderProgram& ShaderVariants::Create(uint32_t key, bool deferred)
+{
+	PROFILE_FUNCTION();
+
+	std::unique_ptr<ShaderProgram>& variant = m_Variants[key];
+	variant = std::make_unique<ShaderProgram>(m_VertexPath.c_str(), m_FragmentPath.c_str(), GetDefines(key), deferred);
+	if (m_OnCreate)
+	{
+		m_OnCreate(*variant);
+	}
+	return *variant;
+}
+
+ShaderProgram& ShaderVariants::Get(uint32_t key)
+{
+	if (m_Variants.empty())
+	{
+		m_Variants.resize(size_t(1) << m_KeyBits);
+	}
+
+	// Bits no keyword uses would only alias existing variants
+	key &= static_cast<uint32_t>(m_Variants.size() - 1);
+	std::unique_ptr<ShaderProgram>& variant = m_Variants[key];
+	if (!variant)
+	{
+		return Create(key, false);
+	}
+
+	// Prewarmed variants may still be compiling
+	variant->Finish();
+	return *variant;
+}
+
+size_t ShaderVariants::Prewarm(const char* path)
+{
+	PROFILE_FUNCTION();
+
+	std::ifstream file(path);
+	if (!file)
+	{
+		return 0;
+	}
+
+	if (m_Variants.empty())
+	{
+		m_Variants.resize(size_t(1) << m_KeyBits);
+	}
+
+	std::vector<ShaderProgram*> submitted;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		unsigned long key = 0;
+		if (std::sscanf(line.c_str(), "%lx", &key) != 1 || key >= m_Variants.size())
+		{
+			// Stale list from a build with different keywords
+			continue;
+		}
+		if (!m_Variants[key])
+		{
+			submitted.push_back(&Create(static_cast<uint32_t>(key), true));
+		}
+	}
+
+	for (ShaderProgram* variant : submitted)
+	{
+		variant->Finish();
+	}
+	return submitted.size();
+}
+
+bool ShaderVariants::SaveUsedKeys(const char* path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "ERROR::SHADER_VARIANTS::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+
+	for (size_t key = 0; key < m_Variants.size(); key++)
+	{
+		if (m_Variants[key])
+		{
+			char text[16];
+			std::snprintf(text, sizeof(text), "%zx\n", key);
+			file << text;
+		}
+	}
+	return static_cast<bool>(file);
+}
+
+size_t ShaderVariants::GetBuiltCount() const
+{
+	size_t count = 0;
+	for (const std::unique_ptr<ShaderProgram>& variant : m_Variants)
+	{
+		count += variant != nullptr;
+	}
+	return count;
+}
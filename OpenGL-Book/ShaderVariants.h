@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "ShaderProgram.h"
+
+// A range of bits in a variant key
+struct ShaderKeyword
+{
+	unsigned int shift = 0;
+	uint32_t mask = 0;
+};
+
+// All compile time specializations of one pair of sources. Keywords turn into #defines through the ShaderPreprocessor:
+// a toggle defines its name when set, an enum defines the name of its selected value.
+// A variant is compiled the first time it is asked for, or up front from a list recorded by an earlier run,
+// and looked up by its key in a flat table.
+class ShaderVariants
+{
+public:
+	using CreateCallback = std::function<void(ShaderProgram&)>;
+
+	// Keys index a table of 1 << keyBits entries, so keep the keyword count small
+	static constexpr unsigned int maxKeyBits = 12;
+
+	ShaderVariants(const char* vertexPath, const char* fragmentPath);
+
+	ShaderVariants(const ShaderVariants&) = delete;
+	ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+	// Keywords have to be added before the first variant is built
+	ShaderKeyword AddToggle(const char* name);
+	// At least two values, a keyword that is always defined is just a define
+	ShaderKeyword AddEnum(std::vector<std::string> values);
+
+	static uint32_t SetKeyword(uint32_t key, ShaderKeyword keyword, uint32_t value)
+	{
+		return (key & ~(keyword.mask << keyword.shift)) | ((value & keyword.mask) << keyword.shift);
+	}
+
+	// Runs for every variant that gets built, e.g. to hand it to a ShaderWatcher
+	void SetCreateCallback(CreateCallback onCreate)
+	{
+		m_OnCreate = std::move(onCreate);
+	}
+
+	// Compiles the variant on first use, blocking. Check IsLinked() on the result, a variant can fail on its own.
+	ShaderProgram& Get(uint32_t key);
+
+	// Submits every key listed in the file (one hex key per line, see SaveUsedKeys) before finishing any,
+	// so the driver can compile them in parallel. Returns the number of variants built.
+	size_t Prewarm(const char* path);
+
+	// Writes the keys of every variant built so far, for the next run's Prewarm()
+	bool SaveUsedKeys(const char* path) const;
+
+	std::vector<ShaderDefine> GetDefines(uint32_t key) const;
+
+	size_t GetBuiltCount() const;
+
+private:
+	struct Keyword
+	{
+		ShaderKeyword bits;
+		// One name for a toggle, one per value for an enum
+		std::vector<std::string> names;
+	};
+
+	ShaderKeyword AddKeyword(std::vector<std::string> names, unsigned int bitCount);
+	ShaderProgram& Create(uint32_t key, bool deferred);
+
+private:
+	std::string m_VertexPath;
+	std::string m_FragmentPath;
+	std::vector<Keyword> m_Keywords;
+	unsigned int m_KeyBits = 0;
+
+	CreateCallback m_OnCreate;
+	// Indexed by key, empty until the first Get()
+	std::vector<std::unique_ptr<ShaderProgram>> m_Variants;
+};
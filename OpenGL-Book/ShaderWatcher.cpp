@@ -0,0 +1,273 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include "ShaderWatcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace
+{
+	std::string NormalizePath(const std::string& path)
+	{
+		return ShaderPreprocessor::NormalizePath(path);
+	}
+
+	long long GetWriteTime(const std::string& path)
+	{
+		std::error_code error;
+		auto writeTime = std::filesystem::last_write_time(path, error);
+		return error ? 0 : static_cast<long long>(writeTime.time_since_epoch().count());
+	}
+
+	bool ReadFile(const std::string& path, std::string& contents)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		contents.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		return static_cast<bool>(file.read(&contents[0], contents.size()));
+	}
+}
+
+ShaderWatcher::ShaderWatcher()
+	: m_IsRunning(true)
+{
+#ifdef __linux__
+	m_InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_InotifyFd < 0)
+	{
+		std::cerr << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED, falling back to polling" << std::endl;
+	}
+#endif
+
+	m_Thread = std::thread(&ShaderWatcher::ThreadMain, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	m_IsRunning = false;
+	m_Thread.join();
+
+#ifdef __linux__
+	if (m_InotifyFd >= 0)
+	{
+		close(m_InotifyFd);
+	}
+#endif
+}
+
+void ShaderWatcher::Watch(ShaderProgram& program, ReloadCallback onReload)
+{
+	m_Programs.push_back({ &program, std::move(onReload) });
+	for (const std::string& path : program.GetDependencies())
+	{
+		WatchFile(path);
+	}
+	// Also covers a program whose sources failed to load, it has no dependencies yet
+	WatchFile(program.GetVertexPath());
+	WatchFile(program.GetFragmentPath());
+}
+
+void ShaderWatcher::WatchFile(const std::string& path)
+{
+	std::string normalizedPath = NormalizePath(path);
+
+	WatchedFile file;
+	file.writeTime = GetWriteTime(normalizedPath);
+	ReadFile(normalizedPath, file.source);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Files.count(normalizedPath))
+	{
+		return;
+	}
+	m_Files[normalizedPath] = std::move(file);
+
+#ifdef __linux__
+	if (m_InotifyFd >= 0)
+	{
+		// Watch the directory rather than the file, most editors save by writing a new file and renaming it over the old one
+		std::string directory = std::filesystem::path(normalizedPath).parent_path().generic_string();
+		int watch = inotify_add_watch(m_InotifyFd, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watch >= 0)
+		{
+			m_WatchDirectories[watch] = directory;
+		}
+	}
+#endif
+}
+
+void ShaderWatcher::ThreadMain()
+{
+	using namespace std::chrono_literals;
+
+	while (m_IsRunning)
+	{
+#ifdef __linux__
+		if (m_InotifyFd >= 0)
+		{
+			pollfd pollFd = { m_InotifyFd, POLLIN, 0 };
+			if (poll(&pollFd, 1, 100) <= 0)
+			{
+				continue;
+			}
+
+			alignas(inotify_event) char buffer[4096];
+			ssize_t length;
+			while ((length = read(m_InotifyFd, buffer, sizeof(buffer))) > 0)
+			{
+				for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(ptr)->len)
+				{
+					const inotify_event* event = reinterpret_cast<inotify_event*>(ptr);
+					if (event->len == 0)
+					{
+						continue;
+					}
+
+					std::string path;
+					{
+						std::lock_guard<std::mutex> lock(m_Mutex);
+						auto it = m_WatchDirectories.find(event->wd);
+						if (it == m_WatchDirectories.end())
+						{
+							continue;
+						}
+						path = NormalizePath((std::filesystem::path(it->second) / event->name).generic_string());
+						if (!m_Files.count(path))
+						{
+							continue;
+						}
+					}
+					OnFileChanged(path);
+				}
+			}
+			continue;
+		}
+#endif
+
+		// Portable fallback, compare write times a few times a second
+		std::vector<std::pair<std::string, long long>> files;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (const auto& [path, file] : m_Files)
+			{
+				files.emplace_back(path, file.writeTime);
+			}
+		}
+
+		for (const auto& [path, writeTime] : files)
+		{
+			if (GetWriteTime(path) != writeTime)
+			{
+				OnFileChanged(path);
+			}
+		}
+
+		std::this_thread::sleep_for(250ms);
+	}
+}
+
+void ShaderWatcher::OnFileChanged(const std::string& path)
+{
+	// Reading happens here so the GL thread only ever sees complete sources
+	std::string source;
+	long long writeTime = GetWriteTime(path);
+	if (!ReadFile(path, source) || source.empty())
+	{
+		// Probably caught the editor halfway through saving, the next event will pick it up
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	WatchedFile& file = m_Files[path];
+	file.writeTime = writeTime;
+	if (file.source == source)
+	{
+		return;
+	}
+	file.source = std::move(source);
+
+	if (std::find(m_ChangedFiles.begin(), m_ChangedFiles.end(), path) == m_ChangedFiles.end())
+	{
+		m_ChangedFiles.push_back(path);
+	}
+}
+
+void ShaderWatcher::Update()
+{
+	// Reloads submitted on earlier frames are swapped in once the driver is done with them
+	for (WatchedProgram& watched : m_Programs)
+	{
+		ShaderProgram& program = *watched.program;
+		if (!program.IsReloading() || !program.IsReloadReady())
+		{
+			continue;
+		}
+
+		if (!program.EndReload())
+		{
+			std::cerr << "ERROR::SHADER_WATCHER::RELOAD_FAILED " << program.GetVertexPath() << " " << program.GetFragmentPath() << ", keeping the old program" << std::endl;
+			continue;
+		}
+
+		// An edit may have pulled in a new include
+		for (const std::string& path : program.GetDependencies())
+		{
+			WatchFile(path);
+		}
+
+		std::cout << "reloaded " << program.GetVertexPath() << " " << program.GetFragmentPath() << std::endl;
+		if (watched.onReload)
+		{
+			watched.onReload(program);
+		}
+	}
+
+	std::vector<std::string> changedFiles;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_ChangedFiles.empty())
+		{
+			return;
+		}
+		changedFiles.swap(m_ChangedFiles);
+	}
+
+	// Refresh the preprocessor's copies first so includes shared by several programs are parsed once
+	std::vector<std::string> sources;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (const std::string& path : changedFiles)
+		{
+			sources.push_back(m_Files[path].source);
+		}
+	}
+	for (size_t i = 0; i < changedFiles.size(); i++)
+	{
+		ShaderPreprocessor::UpdateFile(changedFiles[i], std::move(sources[i]));
+	}
+
+	for (WatchedProgram& watched : m_Programs)
+	{
+		ShaderProgram& program = *watched.program;
+		bool hasChanged = std::any_of(changedFiles.begin(), changedFiles.end(), [&program](const std::string& path)
+		{
+			return program.DependsOn(path) || path == NormalizePath(program.GetVertexPath()) || path == NormalizePath(program.GetFragmentPath());
+		});
+		// Only submitted here, the frame doesn't wait for the compile. Swapped in by a later Update().
+		if (hasChanged && !program.BeginReload())
+		{
+			std::cerr << "ERROR::SHADER_WATCHER::RELOAD_FAILED " << program.GetVertexPath() << " " << program.GetFragmentPath() << ", keeping the old program" << std::endl;
+		}
+	}
+}
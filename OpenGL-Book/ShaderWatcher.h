@@ -0,0 +1,67 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "ShaderProgram.h"
+
+// Watches the source files of a set of programs, includes too, and hot reloads every program that depends on a file that changed.
+// A background thread waits for file changes (inotify on Linux, polling the write time elsewhere)
+// and reads the new sources. The GL thread calls Update() once per frame, it submits the new programs and swaps them
+// in on a later frame once the driver reports them complete, so the frame never waits for a compile.
+class ShaderWatcher
+{
+public:
+	using ReloadCallback = std::function<void(ShaderProgram&)>;
+
+	ShaderWatcher();
+	~ShaderWatcher();
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// onReload runs after a successful swap, use it to set the uniforms again
+	void Watch(ShaderProgram& program, ReloadCallback onReload = nullptr);
+
+	// Starts rebuilding the programs whose files changed and swaps in the finished ones, call from the thread that owns the GL context
+	void Update();
+
+private:
+	struct WatchedProgram
+	{
+		ShaderProgram* program;
+		ReloadCallback onReload;
+	};
+
+	struct WatchedFile
+	{
+		std::string source;
+		long long writeTime;
+	};
+
+	void WatchFile(const std::string& path);
+	void ThreadMain();
+	// Runs on the watcher thread, queues the new source for Update()
+	void OnFileChanged(const std::string& path);
+
+private:
+	std::vector<WatchedProgram> m_Programs;
+
+	std::mutex m_Mutex;
+	// Everything below is shared with the watcher thread
+	std::unordered_map<std::string, WatchedFile> m_Files;
+	std::vector<std::string> m_ChangedFiles;
+
+	std::atomic<bool> m_IsRunning;
+	std::thread m_Thread;
+
+#ifdef __linux__
+	int m_InotifyFd = -1;
+	// inotify watch descriptor -> watched directory
+	std::unordered_map<int, std::string> m_WatchDirectories;
+#endif
+};
@@ -0,0 +1,82 @@
+#include <iostream>
+#include "StagingPool.h"
+
+StagingPool::StagingPool(size_t maxRetainedSize)
+	: m_MaxRetainedSize(maxRetainedSize)
+{
+}
+
+StagingPool::~StagingPool()
+{
+	for (std::vector<unsigned char*>& freeBlocks : m_FreeBlocks)
+	{
+		for (unsigned char* data : freeBlocks)
+		{
+			delete[] data;
+		}
+	}
+}
+
+int StagingPool::GetSizeClass(size_t size)
+{
+	int sizeClass = 0;
+	while (sizeClass < sizeClassCount && GetClassSize(sizeClass) < size)
+	{
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+StagingPool::Block StagingPool::Acquire(size_t size)
+{
+	Block block;
+	int sizeClass = GetSizeClass(size);
+	if (sizeClass == sizeClassCount)
+	{
+		std::cerr << "ERROR::STAGING_POOL::BLOCK_TOO_LARGE " << size << std::endl;
+		return block;
+	}
+
+	block.size = size;
+	block.sizeClass = sizeClass;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::vector<unsigned char*>& freeBlocks = m_FreeBlocks[sizeClass];
+		if (!freeBlocks.empty())
+		{
+			block.data = freeBlocks.back();
+			freeBlocks.pop_back();
+			m_RetainedSize -= GetClassSize(sizeClass);
+			m_ReuseCount++;
+			return block;
+		}
+		m_AllocationCount++;
+	}
+
+	// Allocated outside the lock, the heap has its own
+	block.data = new unsigned char[GetClassSize(sizeClass)];
+	return block;
+}
+
+void StagingPool::Release(Block& block)
+{
+	if (!block.data)
+	{
+		return;
+	}
+
+	int sizeClass = block.sizeClass;
+	size_t classSize = GetClassSize(sizeClass);
+	unsigned char* data = block.data;
+	block = Block();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_RetainedSize + classSize <= m_MaxRetainedSize)
+		{
+			m_FreeBlocks[sizeClass].push_back(data);
+			m_RetainedSize += classSize;
+			return;
+		}
+	}
+	delete[] data;
+}
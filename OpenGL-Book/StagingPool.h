@@ -0,0 +1,62 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Reusable CPU memory for data on its way to the GPU, e.g. decoded images waiting for their upload.
+// Blocks come in power of two size classes, so an image of a similar size takes over the block the last one
+// gave back instead of going to the heap again. Acquire() and Release() can be called from any thread.
+class StagingPool
+{
+public:
+	struct Block
+	{
+		unsigned char* data = nullptr;
+		size_t size = 0;		// the requested size, the allocation itself is the whole size class
+		int sizeClass = -1;
+	};
+
+	// Released blocks beyond maxRetainedSize bytes go back to the heap
+	explicit StagingPool(size_t maxRetainedSize = 64 * 1024 * 1024);
+	~StagingPool();
+
+	StagingPool(const StagingPool&) = delete;
+	StagingPool& operator=(const StagingPool&) = delete;
+
+	Block Acquire(size_t size);
+	// Resets block, releasing an empty block does nothing
+	void Release(Block& block);
+
+	// How many Acquire() calls had to allocate / could reuse a block, for tuning maxRetainedSize
+	unsigned int GetAllocationCount() const
+	{
+		return m_AllocationCount;
+	}
+
+	unsigned int GetReuseCount() const
+	{
+		return m_ReuseCount;
+	}
+
+private:
+	static constexpr size_t minBlockSize = 64 * 1024;
+	static constexpr int sizeClassCount = 24;
+
+	static int GetSizeClass(size_t size);
+	static size_t GetClassSize(int sizeClass)
+	{
+		return minBlockSize << sizeClass;
+	}
+
+private:
+	std::mutex m_Mutex;
+	std::vector<unsigned char*> m_FreeBlocks[sizeClassCount];
+	size_t m_RetainedSize = 0;
+	size_t m_MaxRetainedSize;
+
+	// Read without the lock by whoever prints them
+	std::atomic<unsigned int> m_AllocationCount = 0;
+	std::atomic<unsigned int> m_ReuseCount = 0;
+};
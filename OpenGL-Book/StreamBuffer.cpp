@@ -0,0 +1,142 @@
+#include <iostream>
+#include "GLState.h"
+#include "StreamBuffer.h"
+
+StreamBuffer::StreamBuffer(GLenum target, size_t regionSize, int regionCount)
+	: m_Target(target), m_RegionSize(regionSize), m_RegionCount(regionCount < maxRegions ? regionCount : maxRegions)
+{
+	size_t totalSize = m_RegionSize * m_RegionCount;
+
+	glGenBuffers(1, &m_Buffer);
+	GLState::BindBuffer(m_Target, m_Buffer);
+
+	if (GLAD_GL_VERSION_4_4)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(m_Target, totalSize, nullptr, flags);
+		m_PersistentData = static_cast<char*>(glMapBufferRange(m_Target, 0, totalSize, flags));
+		if (!m_PersistentData)
+		{
+			std::cerr << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+		}
+	}
+	else
+	{
+		glBufferData(m_Target, totalSize, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	DeleteFences();
+
+	if (m_PersistentData || m_IsMapped)
+	{
+		GLState::BindBuffer(m_Target, m_Buffer);
+		glUnmapBuffer(m_Target);
+	}
+
+	GLState::OnBufferDeleted(m_Buffer);
+	glDeleteBuffers(1, &m_Buffer);
+}
+
+StreamAllocation StreamBuffer::Map(size_t size, size_t alignment)
+{
+	StreamAllocation allocation;
+
+	size_t offset = (m_Offset + alignment - 1) / alignment * alignment;
+	size_t regionEnd = (m_Region + 1) * m_RegionSize;
+	if (offset + size > regionEnd)
+	{
+		return allocation;
+	}
+
+	if (m_PersistentData)
+	{
+		allocation.data = m_PersistentData + offset;
+	}
+	else
+	{
+		// The fences already guarantee the GPU is done with this range, don't let the driver synchronize on its own
+		GLState::BindBuffer(m_Target, m_Buffer);
+		if (m_IsMapped)
+		{
+			glUnmapBuffer(m_Target);
+		}
+		allocation.data = glMapBufferRange(m_Target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+		m_IsMapped = allocation.data != nullptr;
+	}
+
+	allocation.offset = offset;
+	m_Offset = offset + size;
+	return allocation;
+}
+
+void StreamBuffer::Unmap()
+{
+	if (!m_IsMapped)
+	{
+		return;
+	}
+
+	GLState::BindBuffer(m_Target, m_Buffer);
+	glUnmapBuffer(m_Target);
+	m_IsMapped = false;
+}
+
+void StreamBuffer::NextRegion()
+{
+	Unmap();
+
+	if (m_Fences[m_Region])
+	{
+		glDeleteSync(m_Fences[m_Region]);
+	}
+	m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_Region = (m_Region + 1) % m_RegionCount;
+	m_Offset = m_Region * m_RegionSize;
+
+	GLsync fence = m_Fences[m_Region];
+	if (!fence)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+	{
+		glDeleteSync(fence);
+		m_Fences[m_Region] = nullptr;
+		return;
+	}
+
+	if (!m_PersistentData)
+	{
+		// The GPU is more than regionCount frames behind. Give the old storage to the driver and start on fresh memory
+		// instead of waiting, every pending fence refers to the old storage so they can all go.
+		GLState::BindBuffer(m_Target, m_Buffer);
+		glBufferData(m_Target, m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW);
+		DeleteFences();
+		m_OrphanCount++;
+		return;
+	}
+
+	// Immutable storage can't be orphaned, this is the only place the persistent path can block
+	glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	glDeleteSync(fence);
+	m_Fences[m_Region] = nullptr;
+	m_StallCount++;
+}
+
+void StreamBuffer::DeleteFences()
+{
+	for (GLsync& fence : m_Fences)
+	{
+		if (fence)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+struct StreamAllocation
+{
+	void* data = nullptr;	// nullptr if the request didn't fit in the current region
+	size_t offset = 0;		// byte offset into the GL buffer, for attribute pointers / draw offsets
+};
+
+// Ring buffer for data that changes every frame. The buffer is split into regionCount regions (triple buffered by
+// default) and every region is guarded by a fence, so the CPU only writes memory the GPU is done with.
+// With GL 4.4 the whole buffer is mapped once (glBufferStorage, persistent + coherent). On plain 3.3 each write maps
+// its range unsynchronized, and if the GPU still holds the next region the buffer is orphaned instead of waited on.
+class StreamBuffer
+{
+public:
+	StreamBuffer(GLenum target, size_t regionSize, int regionCount = 3);
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// Reserves size bytes in the current region, write them before the next Unmap()
+	StreamAllocation Map(size_t size, size_t alignment = 4);
+
+	// Must be called before drawing from what was just written, a no-op for the persistent path
+	void Unmap();
+
+	// Fences the current region and moves on to the next one. Call once per frame, or early when Map() runs out of space.
+	void NextRegion();
+
+	unsigned int GetBuffer() const
+	{
+		return m_Buffer;
+	}
+
+	size_t GetRegionSize() const
+	{
+		return m_RegionSize;
+	}
+
+	// Bytes left in the current region, not counting alignment padding
+	size_t GetRemainingSize() const
+	{
+		return (m_Region + 1) * m_RegionSize - m_Offset;
+	}
+
+	bool IsPersistent() const
+	{
+		return m_PersistentData != nullptr;
+	}
+
+	// How often NextRegion() had to wait for the GPU / orphaned the buffer since creation
+	unsigned int GetStallCount() const
+	{
+		return m_StallCount;
+	}
+
+	unsigned int GetOrphanCount() const
+	{
+		return m_OrphanCount;
+	}
+
+private:
+	static constexpr int maxRegions = 4;
+
+	void DeleteFences();
+
+private:
+	GLenum m_Target;
+	unsigned int m_Buffer = 0;
+	size_t m_RegionSize;
+	int m_RegionCount;
+
+	int m_Region = 0;
+	size_t m_Offset = 0;
+	GLsync m_Fences[maxRegions] = {};
+
+	char* m_PersistentData = nullptr;
+	bool m_IsMapped = false;
+
+	unsigned int m_StallCount = 0;
+	unsigned int m_OrphanCount = 0;
+};
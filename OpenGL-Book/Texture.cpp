@@ -0,0 +1,80 @@
+#include "GLState.h"
+#include "Texture.h"
+
+Texture::Texture(int width, int height, const TextureParameters& parameters)
+	: m_Width(width), m_Height(height), m_LevelCount(parameters.isMipmapped ? GetMipLevelCount(width, height) : 1)
+{
+	glGenTextures(1, &m_Texture);
+	Bind(0);
+
+	if (GLAD_GL_VERSION_4_2)
+	{
+		glTexStorage2D(GL_TEXTURE_2D, m_LevelCount, GL_RGBA8, width, height);
+	}
+	else
+	{
+		// A null pointer would be read as offset 0 of a bound unpack buffer
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		for (int level = 0; level < m_LevelCount; level++)
+		{
+			int levelWidth = width >> level > 0 ? width >> level : 1;
+			int levelHeight = height >> level > 0 ? height >> level : 1;
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		}
+		// Mutable textures are incomplete until every level the filter may sample exists, this limits it to ours
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_LevelCount - 1);
+	}
+
+	GLenum minFilter = parameters.minFilter;
+	if (!parameters.isMipmapped && minFilter != GL_NEAREST)
+	{
+		minFilter = GL_LINEAR;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, parameters.magFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, parameters.wrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, parameters.wrapT);
+}
+
+Texture::~Texture()
+{
+	GLState::OnTextureDeleted(m_Texture);
+	glDeleteTextures(1, &m_Texture);
+}
+
+void Texture::SetPixels(const void* pixels, int level)
+{
+	int levelWidth = m_Width >> level > 0 ? m_Width >> level : 1;
+	int levelHeight = m_Height >> level > 0 ? m_Height >> level : 1;
+
+	Bind(0);
+	// RGBA8 rows are always 4 byte aligned, the default unpack alignment already fits
+	glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidth, levelHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+void Texture::GenerateMipmaps()
+{
+	if (m_LevelCount == 1)
+	{
+		return;
+	}
+	Bind(0);
+	glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void Texture::Bind(unsigned int unit) const
+{
+	GLState::BindTexture(unit, GL_TEXTURE_2D, m_Texture);
+}
+
+int Texture::GetMipLevelCount(int width, int height)
+{
+	int size = width > height ? width : height;
+	int levelCount = 1;
+	while (size > 1)
+	{
+		size >>= 1;
+		levelCount++;
+	}
+	return levelCount;
+}
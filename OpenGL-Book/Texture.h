@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+
+struct TextureParameters
+{
+	GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLenum magFilter = GL_LINEAR;
+	GLenum wrapS = GL_REPEAT;
+	GLenum wrapT = GL_REPEAT;
+	// Allocates the whole mip chain, fill it with GenerateMipmaps() after the first level is uploaded
+	bool isMipmapped = true;
+};
+
+// RGBA8 2D texture with its storage allocated up front, so filling it is only ever glTexSubImage2D.
+// Storage is immutable (glTexStorage2D) where GL 4.2 is available, otherwise every level is specified once.
+class Texture
+{
+public:
+	Texture(int width, int height, const TextureParameters& parameters = TextureParameters());
+	~Texture();
+
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	// Tightly packed RGBA8 rows, the first row ends up at t = 0. While a buffer is bound to GL_PIXEL_UNPACK_BUFFER
+	// pixels is an offset into it and the copy runs asynchronously, otherwise it is read before the call returns.
+	void SetPixels(const void* pixels, int level = 0);
+
+	// Builds levels 1..n from level 0 on the GPU
+	void GenerateMipmaps();
+
+	// Binds to texture unit unit (0, 1, ...), the unit is what a sampler uniform is set to
+	void Bind(unsigned int unit) const;
+
+	unsigned int GetTexture() const
+	{
+		return m_Texture;
+	}
+
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+
+	int GetLevelCount() const
+	{
+		return m_LevelCount;
+	}
+
+	// Levels of a full mip chain down to 1x1
+	static int GetMipLevelCount(int width, int height);
+
+private:
+	unsigned int m_Texture = 0;
+	int m_Width;
+	int m_Height;
+	int m_LevelCount;
+};
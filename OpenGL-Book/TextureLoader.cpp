@@ -0,0 +1,196 @@
+#include <cstring>
+#include <iostream>
+#include "GLState.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "TextureLoader.h"
+
+namespace
+{
+	TextureParameters GetPlaceholderParameters()
+	{
+		TextureParameters parameters;
+		parameters.isMipmapped = false;
+		return parameters;
+	}
+}
+
+TextureLoader::TextureLoader(JobSystem& jobs, ResourceLoader* resourceLoader, size_t uploadBudget)
+	: m_Jobs(jobs), m_ResourceLoader(resourceLoader), m_UploadBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBudget), m_Placeholder(1, 1, GetPlaceholderParameters())
+{
+	const unsigned char white[4] = { 255, 255, 255, 255 };
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	m_Placeholder.SetPixels(white);
+}
+
+TextureLoader::~TextureLoader()
+{
+	// The jobs and uploads write into the entries, they have to be done before those go away
+	m_Jobs.Wait(m_Decoding);
+	for (Handle handle : m_Uploading)
+	{
+		m_ResourceLoader->Wait(m_Entries[handle].request);
+	}
+	for (Entry& entry : m_Entries)
+	{
+		m_StagingPool.Release(entry.pixels);
+	}
+}
+
+TextureLoader::Handle TextureLoader::Load(const char* path, const TextureParameters& parameters)
+{
+	Handle handle = m_Entries.size();
+	m_Entries.emplace_back();
+	Entry& entry = m_Entries.back();
+	entry.path = path;
+	entry.parameters = parameters;
+
+	m_Jobs.Run([this, &entry, handle]()
+	{
+		Decode(entry);
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		m_Decoded.push_back(handle);
+	}, &m_Decoding);
+	return handle;
+}
+
+void TextureLoader::Decode(Entry& entry)
+{
+	PROFILE_SCOPE("Decode Image");
+
+	// Decoded straight out of the page cache, the only copy is the decoded image itself
+	MappedFile file;
+	if (!file.Open(entry.path.c_str()) || !ImageDecoder::ReadInfo(file.GetData(), file.GetSize(), entry.info))
+	{
+		std::cerr << "ERROR::TEXTURE_LOADER::CANNOT_LOAD " << entry.path << std::endl;
+		return;
+	}
+
+	entry.pixels = m_StagingPool.Acquire(ImageDecoder::GetDecodedSize(entry.info));
+	if (!entry.pixels.data)
+	{
+		return;
+	}
+	if (!ImageDecoder::Decode(file.GetData(), file.GetSize(), entry.info, entry.pixels.data))
+	{
+		std::cerr << "ERROR::TEXTURE_LOADER::CANNOT_DECODE " << entry.path << std::endl;
+		m_StagingPool.Release(entry.pixels);
+		return;
+	}
+	entry.isDecoded = true;
+}
+
+void TextureLoader::Update()
+{
+	PROFILE_FUNCTION();
+
+	// Without worker threads nobody else runs the decode jobs, so they run here
+	if (m_Jobs.GetWorkerCount() == 1 && !m_Decoding.IsDone())
+	{
+		m_Jobs.Wait(m_Decoding);
+	}
+
+	// The loader's uploads are fenced in order, the first one that isn't ready holds up the rest anyway
+	size_t readyCount = 0;
+	while (readyCount < m_Uploading.size() && m_ResourceLoader->IsReady(m_Entries[m_Uploading[readyCount]].request))
+	{
+		m_Entries[m_Uploading[readyCount]].state = State::Ready;
+		readyCount++;
+	}
+	m_Uploading.erase(m_Uploading.begin(), m_Uploading.begin() + readyCount);
+
+	{
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		for (Handle handle : m_Decoded)
+		{
+			Entry& entry = m_Entries[handle];
+			entry.state = entry.isDecoded ? State::Decoded : State::Failed;
+			if (!entry.isDecoded)
+			{
+				continue;
+			}
+
+			if (m_ResourceLoader && m_ResourceLoader->IsThreaded())
+			{
+				// Straight from staging memory, the loader's context has nothing else to wait for while the driver copies
+				entry.state = State::Uploading;
+				entry.request = m_ResourceLoader->Run([this, &entry]()
+				{
+					Upload(entry, 0, entry.pixels.data);
+				});
+				m_Uploading.push_back(handle);
+			}
+			else
+			{
+				m_UploadQueue.push_back(handle);
+			}
+		}
+		m_Decoded.clear();
+	}
+
+	if (!m_UploadQueue.empty())
+	{
+		UploadQueued();
+	}
+}
+
+void TextureLoader::UploadQueued()
+{
+	bool isBufferUsed = false;
+	while (!m_UploadQueue.empty())
+	{
+		Entry& entry = m_Entries[m_UploadQueue.front()];
+		size_t size = entry.pixels.size;
+
+		if (size > m_UploadBuffer.GetRegionSize())
+		{
+			// Never fits the unpack buffer, the driver copies it out of staging memory before the call returns.
+			// Only alone in a frame so it doesn't add to a frame that already uploaded its budget.
+			if (isBufferUsed)
+			{
+				break;
+			}
+			Upload(entry, 0, entry.pixels.data);
+			entry.state = State::Ready;
+			m_UploadQueue.pop_front();
+			break;
+		}
+
+		StreamAllocation allocation = m_UploadBuffer.Map(size, 4);
+		if (!allocation.data)
+		{
+			// This frame's budget is used up, the rest goes next frame
+			break;
+		}
+		std::memcpy(allocation.data, entry.pixels.data, size);
+		m_UploadBuffer.Unmap();
+
+		// With the buffer bound the pointer argument is an offset into it
+		Upload(entry, m_UploadBuffer.GetBuffer(), reinterpret_cast<const void*>(allocation.offset));
+		entry.state = State::Ready;
+		isBufferUsed = true;
+		m_UploadQueue.pop_front();
+	}
+
+	// Every client memory upload elsewhere expects nothing bound here
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (isBufferUsed)
+	{
+		// Fences what was copied this frame, the region is only written again once the GPU has read it
+		m_UploadBuffer.NextRegion();
+	}
+}
+
+void TextureLoader::Upload(Entry& entry, unsigned int unpackBuffer, const void* pixels)
+{
+	PROFILE_SCOPE("Upload Texture");
+
+	// Bound after creating the texture, allocating mutable storage needs the unpack buffer unbound
+	entry.texture = std::make_unique<Texture>(entry.info.width, entry.info.height, entry.parameters);
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+	entry.texture->SetPixels(pixels);
+	entry.texture->GenerateMipmaps();
+
+	// The data is in the unpack buffer or in GL's own copy by now
+	m_StagingPool.Release(entry.pixels);
+}
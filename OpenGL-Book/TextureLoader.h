@@ -0,0 +1,116 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "ImageDecoder.h"
+#include "JobSystem.h"
+#include "ResourceLoader.h"
+#include "StagingPool.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
+
+// Loads PNG / JPEG files into textures without stalling the frame. Reading and decoding run as jobs on the
+// JobSystem, into memory from a StagingPool. With a threaded ResourceLoader the texture is created, filled and
+// mipmapped on the loader's context. Otherwise Update() copies finished images into a GL_PIXEL_UNPACK_BUFFER
+// stream buffer, so the upload is a GPU side copy the driver doesn't have to wait for, and builds the mips on the GL thread.
+// Load() / Update() / Get() belong to the thread that owns the GL context.
+class TextureLoader
+{
+public:
+	using Handle = size_t;
+
+	// uploadBudget is the most bytes going through the unpack buffer per Update(), larger images are copied
+	// straight from staging memory on their own. The job system and resource loader have to outlive the loader.
+	explicit TextureLoader(JobSystem& jobs, ResourceLoader* resourceLoader = nullptr, size_t uploadBudget = 16 * 1024 * 1024);
+	~TextureLoader();
+
+	TextureLoader(const TextureLoader&) = delete;
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	Handle Load(const char* path, const TextureParameters& parameters = TextureParameters());
+
+	// Uploads what finished decoding since the last call, once per frame
+	void Update();
+
+	bool IsReady(Handle handle) const
+	{
+		return m_Entries[handle].state == State::Ready;
+	}
+
+	bool HasFailed(Handle handle) const
+	{
+		return m_Entries[handle].state == State::Failed;
+	}
+
+	// A 1x1 white placeholder until the texture is ready, and for good if it couldn't be loaded
+	const Texture& Get(Handle handle) const
+	{
+		const Entry& entry = m_Entries[handle];
+		return entry.state == State::Ready ? *entry.texture : m_Placeholder;
+	}
+
+	void Bind(Handle handle, unsigned int unit) const
+	{
+		Get(handle).Bind(unit);
+	}
+
+	const StagingPool& GetStagingPool() const
+	{
+		return m_StagingPool;
+	}
+
+private:
+	enum class State
+	{
+		Decoding,
+		Decoded,
+		// Running on the resource loader, until its request is ready
+		Uploading,
+		Ready,
+		Failed
+	};
+
+	struct Entry
+	{
+		std::string path;
+		TextureParameters parameters;
+		State state = State::Decoding;
+
+		// Written by the decode job, read by Update() once the handle came through m_Decoded
+		ImageInfo info;
+		StagingPool::Block pixels;
+		bool isDecoded = false;
+
+		std::unique_ptr<Texture> texture;
+		ResourceLoader::Request request = 0;
+	};
+
+	void Decode(Entry& entry);
+	// pixels is an offset into unpackBuffer, or client memory if unpackBuffer is 0. Leaves the state to the caller,
+	// it may run on the resource loader while the GL thread reads it.
+	void Upload(Entry& entry, unsigned int unpackBuffer, const void* pixels);
+	void UploadQueued();
+
+private:
+	JobSystem& m_Jobs;
+	ResourceLoader* m_ResourceLoader;
+	JobCounter m_Decoding;
+	StagingPool m_StagingPool;
+	StreamBuffer m_UploadBuffer;
+	Texture m_Placeholder;
+
+	// A deque so decode jobs can hold on to their entry while more are added
+	std::deque<Entry> m_Entries;
+
+	// Handed from the decode jobs to Update()
+	std::mutex m_DecodedMutex;
+	std::vector<Handle> m_Decoded;
+	// Decoded but over the budget of the Update() they came in, oldest first
+	std::deque<Handle> m_UploadQueue;
+	// Handed to the resource loader, oldest first
+	std::vector<Handle> m_Uploading;
+};
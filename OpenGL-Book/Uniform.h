@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <glad/glad.h>
+#include "Hash.h"
+
+// Plain layouts matching the GLSL types, matrices are column major like GL expects them
+struct Vec2 { float x, y; };
+struct Vec3 { float x, y, z; };
+struct Vec4 { float x, y, z, w; };
+struct IVec2 { int x, y; };
+struct IVec3 { int x, y, z; };
+struct IVec4 { int x, y, z, w; };
+struct Mat3 { float m[9]; };
+struct Mat4 { float m[16]; };
+
+// Texture unit a sampler reads from
+struct Sampler { int unit; };
+
+// One specialization per C++ type: the GLSL type it matches and the single glUniform* / glProgramUniform* call that sets it.
+// Every setter takes a count so arrays go through the same call.
+template<typename T>
+struct UniformTraits;
+
+#define DEFINE_UNIFORM_TRAITS(Type, glType, Scalar, suffix) \
+	template<> \
+	struct UniformTraits<Type> \
+	{ \
+		static constexpr GLenum type = glType; \
+		static void Set(int location, int count, const Type* values) \
+		{ \
+			glUniform##suffix(location, count, reinterpret_cast<const Scalar*>(values)); \
+		} \
+		static void Set(unsigned int program, int location, int count, const Type* values) \
+		{ \
+			glProgramUniform##suffix(program, location, count, reinterpret_cast<const Scalar*>(values)); \
+		} \
+	}
+
+#define DEFINE_UNIFORM_MATRIX_TRAITS(Type, glType, suffix) \
+	template<> \
+	struct UniformTraits<Type> \
+	{ \
+		static constexpr GLenum type = glType; \
+		static void Set(int location, int count, const Type* values) \
+		{ \
+			glUniformMatrix##suffix(location, count, GL_FALSE, values->m); \
+		} \
+		static void Set(unsigned int program, int location, int count, const Type* values) \
+		{ \
+			glProgramUniformMatrix##suffix(program, location, count, GL_FALSE, values->m); \
+		} \
+	}
+
+DEFINE_UNIFORM_TRAITS(float, GL_FLOAT, GLfloat, 1fv);
+DEFINE_UNIFORM_TRAITS(Vec2, GL_FLOAT_VEC2, GLfloat, 2fv);
+DEFINE_UNIFORM_TRAITS(Vec3, GL_FLOAT_VEC3, GLfloat, 3fv);
+DEFINE_UNIFORM_TRAITS(Vec4, GL_FLOAT_VEC4, GLfloat, 4fv);
+DEFINE_UNIFORM_TRAITS(int, GL_INT, GLint, 1iv);
+DEFINE_UNIFORM_TRAITS(IVec2, GL_INT_VEC2, GLint, 2iv);
+DEFINE_UNIFORM_TRAITS(IVec3, GL_INT_VEC3, GLint, 3iv);
+DEFINE_UNIFORM_TRAITS(IVec4, GL_INT_VEC4, GLint, 4iv);
+DEFINE_UNIFORM_TRAITS(Sampler, GL_SAMPLER_2D, GLint, 1iv);
+DEFINE_UNIFORM_MATRIX_TRAITS(Mat3, GL_FLOAT_MAT3, 3fv);
+DEFINE_UNIFORM_MATRIX_TRAITS(Mat4, GL_FLOAT_MAT4, 4fv);
+
+#undef DEFINE_UNIFORM_TRAITS
+#undef DEFINE_UNIFORM_MATRIX_TRAITS
+
+// True if a value set through UniformTraits<T> with this type can go into a uniform the program declares as reflected.
+// Any sampler takes a Sampler and an int also sets a bool.
+constexpr bool IsUniformTypeCompatible(GLenum type, GLenum reflected)
+{
+	if (type == reflected)
+	{
+		return true;
+	}
+	switch (type)
+	{
+	case GL_INT:
+		return reflected == GL_BOOL;
+	case GL_SAMPLER_2D:
+		// The float, array/shadow and integer sampler enums are three contiguous ranges
+		return (reflected >= GL_SAMPLER_1D && reflected <= GL_SAMPLER_2D_RECT)
+			|| (reflected >= GL_SAMPLER_1D_ARRAY && reflected <= GL_SAMPLER_CUBE_SHADOW)
+			|| (reflected >= GL_INT_SAMPLER_1D && reflected <= GL_UNSIGNED_INT_SAMPLER_2D_ARRAY);
+	default:
+		return false;
+	}
+}
+
+// A uniform name hashed at compile time, declare them constexpr so no string is ever hashed at runtime:
+//     constexpr Uniform<Vec3> lightColor("lightColor");
+//     program.Set(lightColor, { 1.0f, 0.9f, 0.8f });
+// Setting one is a lookup in the program's location table and one GL call, see ShaderProgram::Set().
+template<typename T>
+class Uniform
+{
+public:
+	template<size_t N>
+	constexpr explicit Uniform(const char (&name)[N])
+		: m_Hash(HashString(name, N - 1)), m_Name(name)
+	{
+	}
+
+	constexpr uint32_t GetHash() const
+	{
+		return m_Hash;
+	}
+
+	constexpr const char* GetName() const
+	{
+		return m_Name;
+	}
+
+private:
+	uint32_t m_Hash;
+	const char* m_Name;
+};
@@ -0,0 +1,238 @@
+#include <cstring>
+#include <algorithm>
+#include "UniformBlock.h"
+
+namespace
+{
+	int RoundUp(int value, int alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Column count of matrix types, 0 for everything else
+	int GetMatrixColumns(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: return 2;
+		case GL_FLOAT_MAT3: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4: return 3;
+		case GL_FLOAT_MAT4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3: return 4;
+		default: return 0;
+		}
+	}
+}
+
+int UniformBlockLayout::GetStd140Alignment(GLenum type)
+{
+	switch (type)
+	{
+	case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+		return 4;
+	case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+		return 8;
+	case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+	case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+		return 16;
+	default:
+		// Matrices are arrays of column vectors, which std140 pads to vec4
+		return GetMatrixColumns(type) ? 16 : 0;
+	}
+}
+
+int UniformBlockLayout::GetStd140Size(GLenum type)
+{
+	switch (type)
+	{
+	case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+		return 12;
+	default:
+		return GetMatrixColumns(type) ? GetMatrixColumns(type) * 16 : GetStd140Alignment(type);
+	}
+}
+
+UniformBlockLayout UniformBlockLayout::Reflect(unsigned int program, unsigned int blockIndex)
+{
+	UniformBlockLayout layout;
+	layout.m_Index = blockIndex;
+
+	int nameLength = 0;
+	int dataSize = 0;
+	int memberCount = 0;
+	glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength);
+	glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+	glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &memberCount);
+
+	std::vector<char> name(nameLength > 0 ? nameLength : 1);
+	glGetActiveUniformBlockName(program, blockIndex, static_cast<GLsizei>(name.size()), nullptr, name.data());
+	layout.m_Name = name.data();
+	layout.m_Size = dataSize;
+
+	if (memberCount <= 0)
+	{
+		return layout;
+	}
+
+	std::vector<int> indices(memberCount);
+	glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+	std::vector<GLuint> memberIndices(indices.begin(), indices.end());
+
+	// One query per property for all members at once
+	std::vector<int> types(memberCount), offsets(memberCount), sizes(memberCount), arrayStrides(memberCount), matrixStrides(memberCount);
+	glGetActiveUniformsiv(program, memberCount, memberIndices.data(), GL_UNIFORM_TYPE, types.data());
+	glGetActiveUniformsiv(program, memberCount, memberIndices.data(), GL_UNIFORM_OFFSET, offsets.data());
+	glGetActiveUniformsiv(program, memberCount, memberIndices.data(), GL_UNIFORM_SIZE, sizes.data());
+	glGetActiveUniformsiv(program, memberCount, memberIndices.data(), GL_UNIFORM_ARRAY_STRIDE, arrayStrides.data());
+	glGetActiveUniformsiv(program, memberCount, memberIndices.data(), GL_UNIFORM_MATRIX_STRIDE, matrixStrides.data());
+
+	int maxNameLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<char> memberName(maxNameLength > 0 ? maxNameLength : 1);
+	for (int i = 0; i < memberCount; i++)
+	{
+		int length = 0;
+		glGetActiveUniformName(program, memberIndices[i], static_cast<GLsizei>(memberName.size()), &length, memberName.data());
+
+		// Arrays are reported as "name[0]", store the bare name
+		std::string member(memberName.data(), length);
+		size_t bracket = member.find('[');
+		if (bracket != std::string::npos && member.find('.', bracket) == std::string::npos)
+		{
+			member.resize(bracket);
+		}
+
+		uint32_t hash = HashString(member.c_str(), member.size());
+		layout.m_Members.push_back({ std::move(member), hash, static_cast<GLenum>(types[i]), offsets[i], sizes[i], arrayStrides[i], matrixStrides[i] });
+	}
+
+	std::sort(layout.m_Members.begin(), layout.m_Members.end(), [](const UniformBlockMember& a, const UniformBlockMember& b)
+	{
+		return a.offset < b.offset;
+	});
+	return layout;
+}
+
+UniformBlockLayout& UniformBlockLayout::Add(const char* name, GLenum type, int arraySize)
+{
+	int alignment = GetStd140Alignment(type);
+	int size = GetStd140Size(type);
+	int columns = GetMatrixColumns(type);
+
+	UniformBlockMember member;
+	member.name = name;
+	member.hash = HashString(name);
+	member.type = type;
+	member.arraySize = arraySize;
+	member.arrayStride = 0;
+	member.matrixStride = columns ? 16 : 0;
+
+	if (arraySize > 1)
+	{
+		// Array elements are padded out to vec4, even scalars
+		alignment = RoundUp(alignment, 16);
+		member.arrayStride = RoundUp(size, 16);
+		size = member.arrayStride * arraySize;
+	}
+
+	member.offset = RoundUp(static_cast<int>(m_End), alignment);
+	m_End = member.offset + size;
+
+	// The end of an array or matrix is padded to its base alignment, which std140 keeps at 16
+	if (arraySize > 1 || columns)
+	{
+		m_End = RoundUp(static_cast<int>(m_End), 16);
+	}
+	m_Size = RoundUp(static_cast<int>(m_End), 16);
+
+	m_Members.push_back(std::move(member));
+	return *this;
+}
+
+bool UniformBlockLayout::IsCompatible(const UniformBlockLayout& reflected) const
+{
+	for (const UniformBlockMember& member : reflected.m_Members)
+	{
+		const UniformBlockMember* ours = FindMember(member.hash);
+		if (!ours || ours->type != member.type || ours->offset != member.offset
+			|| (member.arraySize > 1 && ours->arrayStride != member.arrayStride)
+			|| (member.matrixStride && ours->matrixStride != member.matrixStride))
+		{
+			return false;
+		}
+	}
+	return m_Size >= reflected.m_Size || reflected.m_Members.empty();
+}
+
+const UniformBlockMember* UniformBlockLayout::FindMember(uint32_t hash) const
+{
+	for (const UniformBlockMember& member : m_Members)
+	{
+		if (member.hash == hash)
+		{
+			return &member;
+		}
+	}
+	return nullptr;
+}
+
+UniformBlockData::UniformBlockData(const UniformBlockLayout& layout)
+	: m_Layout(layout), m_Data(layout.GetSize())
+{
+}
+
+unsigned char* UniformBlockData::Locate(const char* name, int element, size_t size)
+{
+	const UniformBlockMember* member = m_Layout.FindMember(name);
+	if (!member || element < 0 || element >= member->arraySize)
+	{
+		return nullptr;
+	}
+
+	size_t offset = member->offset + static_cast<size_t>(element) * member->arrayStride;
+	if (offset + size > m_Data.size())
+	{
+		return nullptr;
+	}
+	return m_Data.data() + offset;
+}
+
+void UniformBlockData::SetFloat(const char* name, float value, int element)
+{
+	if (unsigned char* data = Locate(name, element, sizeof(value)))
+	{
+		std::memcpy(data, &value, sizeof(value));
+	}
+}
+
+void UniformBlockData::SetInt(const char* name, int value, int element)
+{
+	if (unsigned char* data = Locate(name, element, sizeof(value)))
+	{
+		std::memcpy(data, &value, sizeof(value));
+	}
+}
+
+void UniformBlockData::SetVector(const char* name, const float* values, int components, int element)
+{
+	if (unsigned char* data = Locate(name, element, components * sizeof(float)))
+	{
+		std::memcpy(data, values, components * sizeof(float));
+	}
+}
+
+void UniformBlockData::SetMatrix(const char* name, const float* values, int columns, int rows, int element)
+{
+	const UniformBlockMember* member = m_Layout.FindMember(name);
+	if (!member || !member->matrixStride)
+	{
+		return;
+	}
+
+	size_t size = (columns - 1) * member->matrixStride + rows * sizeof(float);
+	if (unsigned char* data = Locate(name, element, size))
+	{
+		for (int column = 0; column < columns; column++)
+		{
+			std::memcpy(data + column * member->matrixStride, values + column * rows, rows * sizeof(float));
+		}
+	}
+}
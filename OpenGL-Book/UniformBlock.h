@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glad/glad.h>
+#include "Hash.h"
+
+struct UniformBlockMember
+{
+	std::string name;
+	uint32_t hash;
+	GLenum type;
+	int offset;
+	int arraySize;		// 1 for non arrays
+	int arrayStride;	// 0 for non arrays
+	int matrixStride;	// 0 for non matrices
+};
+
+// Offset table of a uniform block. Either reflected from a linked program or built up front with Add(),
+// which lays the members out by the std140 rules so one table serves every program declaring the block as std140.
+class UniformBlockLayout
+{
+public:
+	UniformBlockLayout() = default;
+
+	explicit UniformBlockLayout(std::string name)
+		: m_Name(std::move(name))
+	{
+	}
+
+	// Queries the block's size and member offsets from a linked program
+	static UniformBlockLayout Reflect(unsigned int program, unsigned int blockIndex);
+
+	// Appends a member at its std140 offset, arraySize > 1 for arrays
+	UniformBlockLayout& Add(const char* name, GLenum type, int arraySize = 1);
+
+	// True if every member of the other layout (e.g. a reflected one) is here with the same type and offsets.
+	// Members the compiler optimized out are simply missing from a reflected layout, which is fine.
+	bool IsCompatible(const UniformBlockLayout& reflected) const;
+
+	const UniformBlockMember* FindMember(uint32_t hash) const;
+
+	const UniformBlockMember* FindMember(const char* name) const
+	{
+		return FindMember(HashString(name));
+	}
+
+	const std::string& GetName() const
+	{
+		return m_Name;
+	}
+
+	unsigned int GetIndex() const
+	{
+		return m_Index;
+	}
+
+	// Bytes a buffer range for this block has to cover
+	size_t GetSize() const
+	{
+		return m_Size;
+	}
+
+	const std::vector<UniformBlockMember>& GetMembers() const
+	{
+		return m_Members;
+	}
+
+	// std140 base alignment and size of a single (non array) value of the given GL type, 0 if unsupported
+	static int GetStd140Alignment(GLenum type);
+	static int GetStd140Size(GLenum type);
+
+private:
+	std::string m_Name;
+	unsigned int m_Index = GL_INVALID_INDEX;
+	size_t m_Size = 0;
+	// End of the last member added with Add(), m_Size is this padded out to 16 bytes like a std140 struct
+	size_t m_End = 0;
+	std::vector<UniformBlockMember> m_Members;
+};
+
+// CPU copy of a block's contents, laid out by a UniformBlockLayout so it can be uploaded with one memcpy.
+// The layout has to outlive the data.
+class UniformBlockData
+{
+public:
+	explicit UniformBlockData(const UniformBlockLayout& layout);
+
+	// Unknown names are ignored, like glUniform* with location -1
+	void SetFloat(const char* name, float value, int element = 0);
+	void SetInt(const char* name, int value, int element = 0);
+	void SetVector(const char* name, const float* values, int components, int element = 0);
+	// Column major, rows floats per column, columns are placed at the member's matrix stride
+	void SetMatrix(const char* name, const float* values, int columns, int rows, int element = 0);
+
+	const void* GetData() const
+	{
+		return m_Data.data();
+	}
+
+	size_t GetSize() const
+	{
+		return m_Data.size();
+	}
+
+	const UniformBlockLayout& GetLayout() const
+	{
+		return m_Layout;
+	}
+
+private:
+	unsigned char* Locate(const char* name, int element, size_t size);
+
+private:
+	const UniformBlockLayout& m_Layout;
+	std::vector<unsigned char> m_Data;
+};
@@ -0,0 +1,39 @@
+#include <cstring>
+#include <iostream>
+#include "GLState.h"
+#include "UniformBufferPool.h"
+
+namespace
+{
+	size_t GetOffsetAlignment()
+	{
+		int alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		return alignment > 0 ? static_cast<size_t>(alignment) : 256;
+	}
+}
+
+UniformBufferPool::UniformBufferPool(size_t regionSize)
+	: m_Alignment(GetOffsetAlignment()), m_Stream(GL_UNIFORM_BUFFER, regionSize)
+{
+}
+
+bool UniformBufferPool::Upload(const UniformBlockData& block, unsigned int binding)
+{
+	return Upload(block.GetData(), block.GetSize(), binding);
+}
+
+bool UniformBufferPool::Upload(const void* data, size_t size, unsigned int binding)
+{
+	StreamAllocation allocation = m_Stream.Map(size, m_Alignment);
+	if (!allocation.data)
+	{
+		std::cerr << "ERROR::UNIFORM_BUFFER_POOL::OUT_OF_SPACE, raise the region size" << std::endl;
+		return false;
+	}
+
+	std::memcpy(allocation.data, data, size);
+	m_Stream.Unmap();
+	GLState::BindBufferRange(GL_UNIFORM_BUFFER, binding, m_Stream.GetBuffer(), allocation.offset, size);
+	return true;
+}
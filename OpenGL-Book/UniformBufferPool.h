@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include "StreamBuffer.h"
+#include "UniformBlock.h"
+
+// One large GL_UNIFORM_BUFFER that every block of a frame is sub-allocated from. Uploading a block is one copy into
+// the stream buffer and one glBindBufferRange, instead of a glUniform* call per member.
+class UniformBufferPool
+{
+public:
+	// regionSize bytes of blocks per frame, the buffer holds a few frames worth (see StreamBuffer)
+	explicit UniformBufferPool(size_t regionSize = 64 * 1024);
+
+	// Copies the block and binds the copy to the binding point, returns false if the frame's region is full
+	bool Upload(const UniformBlockData& block, unsigned int binding);
+	bool Upload(const void* data, size_t size, unsigned int binding);
+
+	// Call once per frame after the last draw that reads from the pool
+	void EndFrame()
+	{
+		m_Stream.NextRegion();
+	}
+
+	size_t GetAlignment() const
+	{
+		return m_Alignment;
+	}
+
+private:
+	size_t m_Alignment;
+	StreamBuffer m_Stream;
+};
@@ -0,0 +1,183 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "VertexFormat.h"
+
+namespace
+{
+	struct FormatInfo
+	{
+		GLint size;
+		GLenum type;
+		GLboolean isNormalized;
+		unsigned int bytes;
+	};
+
+	FormatInfo GetFormatInfo(VertexAttributeFormat format)
+	{
+		switch (format)
+		{
+		case VertexAttributeFormat::Float2: return { 2, GL_FLOAT, GL_FALSE, 8 };
+		case VertexAttributeFormat::Float3: return { 3, GL_FLOAT, GL_FALSE, 12 };
+		case VertexAttributeFormat::Float4: return { 4, GL_FLOAT, GL_FALSE, 16 };
+		case VertexAttributeFormat::Half2: return { 2, GL_HALF_FLOAT, GL_FALSE, 4 };
+		case VertexAttributeFormat::Half4: return { 4, GL_HALF_FLOAT, GL_FALSE, 8 };
+		case VertexAttributeFormat::Int2_10_10_10Rev: return { 4, GL_INT_2_10_10_10_REV, GL_TRUE, 4 };
+		case VertexAttributeFormat::UByte4Norm: return { 4, GL_UNSIGNED_BYTE, GL_TRUE, 4 };
+		}
+		return { 0, GL_FLOAT, GL_FALSE, 0 };
+	}
+
+	// Signed normalized integer with the given number of bits, GL 4.2+ style mapping (-1 and 1 are exact)
+	int32_t ToSnorm(float value, int bits)
+	{
+		float maxValue = static_cast<float>((1 << (bits - 1)) - 1);
+		return static_cast<int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * maxValue));
+	}
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x007FFFFF;
+
+	if (((bits >> 23) & 0xFF) == 0xFF)
+	{
+		// Inf stays inf, NaN stays NaN
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+	}
+	if (exponent >= 31)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+	if (exponent <= 0)
+	{
+		// Too small for a normal half, shift into a denormal (or flush to zero)
+		if (exponent < -10)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x00800000;
+		uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		// Round to nearest even
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	// Round to nearest even, a carry into the exponent is exactly what rounding up should do
+	uint32_t remainder = mantissa & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		half++;
+	}
+	return static_cast<uint16_t>(half);
+}
+
+uint32_t PackInt2_10_10_10Rev(float x, float y, float z, float w)
+{
+	uint32_t packed = 0;
+	packed |= static_cast<uint32_t>(ToSnorm(x, 10)) & 0x3FF;
+	packed |= (static_cast<uint32_t>(ToSnorm(y, 10)) & 0x3FF) << 10;
+	packed |= (static_cast<uint32_t>(ToSnorm(z, 10)) & 0x3FF) << 20;
+	packed |= (static_cast<uint32_t>(ToSnorm(w, 2)) & 0x3) << 30;
+	return packed;
+}
+
+unsigned int VertexFormat::GetSize(VertexAttributeFormat format)
+{
+	return GetFormatInfo(format).bytes;
+}
+
+VertexFormat& VertexFormat::Add(unsigned int location, VertexAttributeFormat format, unsigned int components)
+{
+	FormatInfo info = GetFormatInfo(format);
+	if (components == 0 || components > static_cast<unsigned int>(info.size))
+	{
+		components = info.size;
+	}
+
+	// Every format is a multiple of 4 bytes, so attributes stay 4 byte aligned without padding
+	m_Attributes.push_back({ location, format, components, m_Stride });
+	m_Stride += info.bytes;
+	return *this;
+}
+
+void VertexFormat::Apply(size_t baseOffset) const
+{
+	for (const VertexAttribute& attribute : m_Attributes)
+	{
+		if (attribute.location == unusedLocation)
+		{
+			continue;
+		}
+		FormatInfo info = GetFormatInfo(attribute.format);
+		glVertexAttribPointer(attribute.location, info.size, info.type, info.isNormalized, m_Stride, (void*)(baseOffset + attribute.offset));
+		glEnableVertexAttribArray(attribute.location);
+	}
+}
+
+std::vector<uint8_t> VertexFormat::Pack(const float* src, unsigned int vertexCount, unsigned int srcStride) const
+{
+	std::vector<uint8_t> packed(static_cast<size_t>(vertexCount) * m_Stride);
+	for (unsigned int vertex = 0; vertex < vertexCount; vertex++)
+	{
+		const float* srcVertex = src + static_cast<size_t>(vertex) * srcStride;
+		uint8_t* dstVertex = packed.data() + static_cast<size_t>(vertex) * m_Stride;
+		for (const VertexAttribute& attribute : m_Attributes)
+		{
+			PackAttribute(attribute, srcVertex, dstVertex + attribute.offset);
+			srcVertex += attribute.components;
+		}
+	}
+	return packed;
+}
+
+void VertexFormat::PackAttribute(const VertexAttribute& attribute, const float* src, uint8_t* dst) const
+{
+	// Pad to 4 components, w / alpha default to 1
+	float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	std::copy(src, src + attribute.components, values);
+
+	switch (attribute.format)
+	{
+	case VertexAttributeFormat::Float2:
+	case VertexAttributeFormat::Float3:
+	case VertexAttributeFormat::Float4:
+		std::memcpy(dst, values, GetSize(attribute.format));
+		break;
+	case VertexAttributeFormat::Half2:
+	case VertexAttributeFormat::Half4:
+	{
+		unsigned int count = GetSize(attribute.format) / sizeof(uint16_t);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			uint16_t half = FloatToHalf(values[i]);
+			std::memcpy(dst + i * sizeof(uint16_t), &half, sizeof(half));
+		}
+		break;
+	}
+	case VertexAttributeFormat::Int2_10_10_10Rev:
+	{
+		uint32_t packedValue = PackInt2_10_10_10Rev(values[0], values[1], values[2], values[3]);
+		std::memcpy(dst, &packedValue, sizeof(packedValue));
+		break;
+	}
+	case VertexAttributeFormat::UByte4Norm:
+		for (int i = 0; i < 4; i++)
+		{
+			dst[i] = static_cast<uint8_t>(std::lround(std::clamp(values[i], 0.0f, 1.0f) * 255.0f));
+		}
+		break;
+	}
+}
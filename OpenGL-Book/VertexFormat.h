@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+enum class VertexAttributeFormat
+{
+	Float2,
+	Float3,
+	Float4,
+	Half2,				// GL_HALF_FLOAT
+	Half4,
+	Int2_10_10_10Rev,	// normalized xyzw, 4 bytes. Values have to be in [-1, 1]
+	UByte4Norm			// normalized rgba, 4 bytes
+};
+
+struct VertexAttribute
+{
+	unsigned int location;
+	VertexAttributeFormat format;
+	unsigned int components;	// floats the attribute takes from the source data in Pack()
+	unsigned int offset;
+};
+
+// Describes an interleaved vertex layout, packs float data into it and issues the matching glVertexAttribPointer calls.
+// Compact formats cut bandwidth a lot: Half4 position + UByte4Norm color is 12 bytes, Int2_10_10_10Rev + UByte4Norm
+// is 8, compared to 24 for the float3 + float3 layout of the triangle in Main.cpp.
+class VertexFormat
+{
+public:
+	// Attributes at this location keep their bytes in the vertex but Apply() skips them
+	static constexpr unsigned int unusedLocation = ~0u;
+
+	// components is how many floats the attribute reads per vertex in Pack(), missing ones are filled with
+	// 0 (or 1 for w / alpha). 0 means as many as the format holds.
+	VertexFormat& Add(unsigned int location, VertexAttributeFormat format, unsigned int components = 0);
+
+	// Moves an attribute to another location, see ShaderReflection::BindVertexFormat()
+	VertexFormat& SetLocation(size_t attribute, unsigned int location)
+	{
+		m_Attributes[attribute].location = location;
+		return *this;
+	}
+
+	unsigned int GetStride() const
+	{
+		return m_Stride;
+	}
+
+	const std::vector<VertexAttribute>& GetAttributes() const
+	{
+		return m_Attributes;
+	}
+
+	// Sets up every attribute on the bound VAO, reading from the buffer bound to GL_ARRAY_BUFFER at baseOffset
+	void Apply(size_t baseOffset = 0) const;
+
+	// src holds vertexCount vertices of srcStride floats each, with the attributes' components back to back in the order they were added
+	std::vector<uint8_t> Pack(const float* src, unsigned int vertexCount, unsigned int srcStride) const;
+
+	static unsigned int GetSize(VertexAttributeFormat format);
+
+private:
+	void PackAttribute(const VertexAttribute& attribute, const float* src, uint8_t* dst) const;
+
+private:
+	std::vector<VertexAttribute> m_Attributes;
+	unsigned int m_Stride = 0;
+};
+
+uint16_t FloatToHalf(float value);
+uint32_t PackInt2_10_10_10Rev(float x, float y, float z, float w);
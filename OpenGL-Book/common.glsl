@@ -0,0 +1,7 @@
+#pragma once
+// Shared by every vertex shader that draws the position + color layout (see VertexFormat in Main.cpp)
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+out vec3 ourColor;
+out vec3 vertexPos;
@@ -0,0 +1,16 @@
+#version 330 core
+#include "common.glsl"
+// Per instance, see InstanceBuffer
+layout (location = 2) in vec4 aTransform; // xy = offset, z = scale, w = rotation
+layout (location = 3) in vec3 aInstanceColor;
+
+void main()
+{
+	float s = sin(aTransform.w);
+	float c = cos(aTransform.w);
+	vec2 rotated = vec2(aPos.x * c - aPos.y * s, aPos.x * s + aPos.y * c);
+
+	gl_Position = vec4(rotated * aTransform.z + aTransform.xy, aPos.z, 1.0);
+	ourColor = aColor * aInstanceColor;
+	vertexPos = aPos;
+}
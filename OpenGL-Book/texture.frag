@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 texCoord;
+
+// Texture unit set with ShaderProgram::SetSamplerUnit, see TextureLoader in Main.cpp
+uniform sampler2D image;
+
+void main()
+{
+	FragColor = texture(image, texCoord);
+}
\ No newline at end of file
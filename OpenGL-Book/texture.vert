@@ -0,0 +1,11 @@
+#version 330 core
+// A quad in the top right corner from gl_VertexID alone, drawn as a 4 vertex triangle strip with an empty VAO
+out vec2 texCoord;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	// Images are uploaded top row first, so the top of the quad samples t = 0
+	texCoord = vec2(corner.x, 1.0 - corner.y);
+	gl_Position = vec4(0.35 + corner * 0.6, 0.0, 1.0);
+}
\ No newline at end of file
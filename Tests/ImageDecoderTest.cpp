@@ -0,0 +1,177 @@
+#include <vector>
+#include <initializer_list>
+#include <cstdint>
+#include <iostream>
+#include "ImageDecoder.h"
+
+// Hand built images for the PNG / JPEG decoders, including malformed ones that used to write out of bounds.
+// Returns non-zero on the first failed check, run it under ASan to catch overflows that don't change the result.
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		std::cerr << "FAILED " << __FILE__ << ":" << __LINE__ << " " #condition << std::endl; \
+		return false; \
+	}
+
+namespace
+{
+	using Bytes = std::vector<unsigned char>;
+
+	void Append(Bytes& bytes, std::initializer_list<unsigned char> values)
+	{
+		bytes.insert(bytes.end(), values);
+	}
+
+	void AppendWord(Bytes& bytes, uint32_t value)
+	{
+		Append(bytes, { uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value) });
+	}
+
+	uint32_t Crc32(const unsigned char* data, size_t size)
+	{
+		uint32_t crc = 0xFFFFFFFF;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+			}
+		}
+		return ~crc;
+	}
+
+	void AppendChunk(Bytes& png, const char* type, const Bytes& data)
+	{
+		AppendWord(png, static_cast<uint32_t>(data.size()));
+		size_t start = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+		AppendWord(png, Crc32(png.data() + start, png.size() - start));
+	}
+
+	// 4x4 RGBA, pixel (x, y) = (60x, 60y, 30(x + y), 255). Odd rows use the Sub filter.
+	Bytes MakePng()
+	{
+		Bytes png = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+		Bytes header;
+		AppendWord(header, 4);
+		AppendWord(header, 4);
+		Append(header, { 8, 6, 0, 0, 0 });
+		AppendChunk(png, "IHDR", header);
+		// zlib, fixed Huffman codes
+		AppendChunk(png, "IDAT", {
+			0x78, 0xDA, 0x55, 0xCA, 0x31, 0x15, 0x00, 0x20, 0x10, 0xC3, 0xD0, 0x60, 0x04, 0x25, 0x55, 0x72, 0x4A, 0xAA,
+			0x04, 0x25, 0xE7, 0xAF, 0xC0, 0xC0, 0xC0, 0x90, 0x25, 0xEF, 0x03, 0x44, 0xCC, 0x18, 0xA5, 0xA9, 0x0C, 0x34,
+			0xEF, 0xE0, 0x05, 0x56, 0xE4, 0x8A, 0xED, 0xB4, 0xD7, 0x11, 0x5D, 0x9F, 0xD8, 0xC7, 0xFA, 0x14, 0x85 });
+		AppendChunk(png, "IEND", {});
+		return png;
+	}
+
+	// 8x8 grayscale baseline JPEG whose only block is all zero coefficients, so every sample is 128.
+	// acCounts are the code counts per length of the AC table, one code of length 1 (the end of block) when valid.
+	Bytes MakeJpeg(const Bytes& acCounts)
+	{
+		Bytes jpeg = { 0xFF, 0xD8 };
+
+		Append(jpeg, { 0xFF, 0xDB, 0x00, 0x43, 0x00 });
+		jpeg.insert(jpeg.end(), 64, 1);
+
+		Append(jpeg, { 0xFF, 0xC0, 0x00, 0x0B, 0x08, 0x00, 0x08, 0x00, 0x08, 0x01, 0x01, 0x11, 0x00 });
+
+		// DC table 0: a single 1 bit code for difference category 0
+		Append(jpeg, { 0xFF, 0xC4, 0x00, 0x14, 0x00, 0x01 });
+		jpeg.insert(jpeg.end(), 15, 0);
+		Append(jpeg, { 0x00 });
+
+		// AC table 0, every code's value is the end of block
+		int valueCount = 0;
+		for (unsigned char count : acCounts)
+		{
+			valueCount += count;
+		}
+		size_t length = 2 + 1 + 16 + valueCount;
+		Append(jpeg, { 0xFF, 0xC4, uint8_t(length >> 8), uint8_t(length), 0x10 });
+		jpeg.insert(jpeg.end(), acCounts.begin(), acCounts.end());
+		jpeg.insert(jpeg.end(), 16 - acCounts.size(), 0);
+		jpeg.insert(jpeg.end(), valueCount, 0x00);
+
+		Append(jpeg, { 0xFF, 0xDA, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3F, 0x00 });
+		// DC code 0, end of block code 0, padded with 1 bits
+		Append(jpeg, { 0x3F });
+		Append(jpeg, { 0xFF, 0xD9 });
+		return jpeg;
+	}
+
+	bool Decode(const Bytes& file, ImageInfo& info, std::vector<unsigned char>& pixels)
+	{
+		if (!ImageDecoder::ReadInfo(file.data(), file.size(), info))
+		{
+			return false;
+		}
+		pixels.assign(ImageDecoder::GetDecodedSize(info), 0);
+		return ImageDecoder::Decode(file.data(), file.size(), info, pixels.data());
+	}
+
+	bool TestPng()
+	{
+		ImageInfo info;
+		std::vector<unsigned char> pixels;
+		CHECK(Decode(MakePng(), info, pixels));
+		CHECK(info.width == 4 && info.height == 4);
+		for (int y = 0; y < 4; y++)
+		{
+			for (int x = 0; x < 4; x++)
+			{
+				const unsigned char* pixel = &pixels[(y * 4 + x) * 4];
+				CHECK(pixel[0] == x * 60 && pixel[1] == y * 60 && pixel[2] == (x + y) * 30 && pixel[3] == 255);
+			}
+		}
+		return true;
+	}
+
+	bool TestTruncatedPng()
+	{
+		Bytes png = MakePng();
+		ImageInfo info;
+		std::vector<unsigned char> pixels;
+		for (size_t size = 0; size < png.size(); size++)
+		{
+			Bytes truncated(png.begin(), png.begin() + size);
+			Decode(truncated, info, pixels);
+		}
+		return true;
+	}
+
+	bool TestJpeg()
+	{
+		ImageInfo info;
+		std::vector<unsigned char> pixels;
+		CHECK(Decode(MakeJpeg({ 1 }), info, pixels));
+		CHECK(info.width == 8 && info.height == 8);
+		for (size_t i = 0; i < pixels.size(); i += 4)
+		{
+			CHECK(pixels[i] == 128 && pixels[i + 1] == 128 && pixels[i + 2] == 128 && pixels[i + 3] == 255);
+		}
+		return true;
+	}
+
+	bool TestOversubscribedHuffmanTable()
+	{
+		ImageInfo info;
+		std::vector<unsigned char> pixels;
+		// Three codes of length 1 where only two fit, the third used to be written past the fast lookup table
+		CHECK(!Decode(MakeJpeg({ 3 }), info, pixels));
+		// Full up to length 2, the one length 3 code doesn't fit anymore
+		CHECK(!Decode(MakeJpeg({ 1, 2, 1 }), info, pixels));
+		return true;
+	}
+}
+
+int main()
+{
+	bool isPassing = TestPng() && TestTruncatedPng() && TestJpeg() && TestOversubscribedHuffmanTable();
+	std::cout << (isPassing ? "passed" : "failed") << std::endl;
+	return isPassing ? 0 : 1;
+}